@@ -29,8 +29,6 @@
 #include <utility>
 #include <vector>
 
-#include "ppapi/cpp/url_request_info.h"
-
 #include "nacl_player/common.h"
 
 #include "dash/media_stream.h"
@@ -61,6 +59,13 @@ enum class StreamType : int32_t {
   MaxStreamTypes = static_cast<int32_t>(MediaStreamType::MaxTypes)
 };
 
+// A strategy of choosing a representation of a stream during playback.
+enum class AbrPolicyType : int32_t {
+  kThroughput = 0,       // by an estimated network throughput
+  kBufferBased = 1,      // by an amount of buffered media
+  kModelPredictive = 2,  // by planning upcoming segments of known sizes
+};
+
 const Samsung::NaClPlayer::TimeTicks kEndOfStream =
     std::numeric_limits<Samsung::NaClPlayer::TimeTicks>::infinity();
 
@@ -108,12 +113,94 @@ inline auto WeakBind(
       std::forward<Args>(args)...);
 }
 
-pp::URLRequestInfo GetRequestForURL(const std::string& url);
+// A mount point of an html5fs persistent storage.
+const char kPersistentStoragePath[] = "/persistent";
+
+// Mounts a persistent storage at kPersistentStoragePath once per module, a
+// mount is shared by all players. Returns false if a storage isn't
+// available. Accessing html5fs blocks, so this must not be called on the main
+// thread.
+bool MountPersistentStorage();
+
+// A description of an HTTP request which doesn't depend on a transport used
+// to send it (see Transport).
+struct HttpRequest {
+  explicit HttpRequest(const std::string& request_url = std::string())
+      : url(request_url),
+        method("GET") {}
+
+  std::string url;
+  std::string method;
+  // Additional headers, one "Name: value" per line.
+  std::string headers;
+  std::vector<uint8_t> body;
+};
+
+// Times (in seconds) from a start of a request until subsequent phases of a
+// transfer are completed, or -1 if a transport doesn't measure a phase.
+struct TransferTiming {
+  TransferTiming()
+      : name_lookup(-1.),
+        connect(-1.),
+        first_byte(-1.),
+        total(-1.) {}
+
+  double name_lookup;
+  double connect;
+  double first_byte;
+  double total;
+};
+
+struct HttpResponseInfo {
+  HttpResponseInfo() : status_code(0) {}
+
+  // An HTTP status code, or 0 if no response was received.
+  int32_t status_code;
+  TransferTiming timing;
+};
+
+HttpRequest GetRequestForURL(const std::string& url);
+
+// Returns a length of a response body given in response headers (one header
+// per line) by Content-Length or, if there is none, by Content-Range. Returns
+// -1 if the length is unknown.
+int64_t ContentLengthFromHeaders(const std::string& headers);
 
-int32_t ProcessURLRequestOnSideThread(const pp::URLRequestInfo& request,
+int32_t ProcessURLRequestOnSideThread(const HttpRequest& request,
                                       std::string* out);
 
-int32_t ProcessURLRequestOnSideThread(const pp::URLRequestInfo& request,
+int32_t ProcessURLRequestOnSideThread(const HttpRequest& request,
                                       std::vector<uint8_t>* out);
 
+// Called after each chunk of a response body is received with a number of
+// bytes received so far and an expected total (-1 if a response has no
+// Content-Length). Returning false aborts a request.
+typedef std::function<bool(size_t bytes_received, int64_t total_bytes)>
+    DownloadProgressCallback;
+
+// Same as above, but reports download progress to a given callback. If the
+// callback aborts a download, PP_ERROR_ABORTED is returned.
+int32_t ProcessURLRequestOnSideThread(const HttpRequest& request,
+                                      std::vector<uint8_t>* out,
+                                      const DownloadProgressCallback& progress);
+
+// Called with each piece of a response body as it's received and an
+// expected total size (-1 if a response has no Content-Length). Returning
+// false aborts a request.
+typedef std::function<bool(const uint8_t* data, size_t size,
+                           int64_t total_bytes)> DownloadDataCallback;
+
+// Same as above, but passes a response body to a given callback piece by
+// piece instead of gathering it in memory. If the callback aborts a
+// download, PP_ERROR_ABORTED is returned.
+int32_t StreamURLRequestOnSideThread(const HttpRequest& request,
+                                     const DownloadDataCallback& on_data);
+
+// Same as above, but fills a given response info, e.g. to tell whether a
+// Range request was honoured or how long a transfer took. A status code is
+// set before any data is passed to a callback.
+int32_t StreamURLRequestOnSideThread(const HttpRequest& request,
+                                     const DownloadDataCallback& on_data,
+                                     HttpResponseInfo* response);
+
 #endif  // NATIVE_PLAYER_SRC_COMMON_H_
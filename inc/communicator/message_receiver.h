@@ -143,13 +143,72 @@ class MessageReceiver : public pp::MessageHandler {
   ///   used when requesting license from license server
   ///   (see <code>license_url</code>). It is an optional parameter, which
   ///   has to be a <code>dictionary</code> type value.
+  /// @param[in] start_time A playback position at which playback should
+  ///   start. It is an optional parameter, which has to be a
+  ///   <code>double</code> type value.
+  /// @param[in] device_class A class of a device the player runs on. It is an
+  ///   optional parameter, which has to be an <code>int</code> type value
+  ///   casted to <code>DeviceClassEnum</code>.
+  /// @param[in] abr_policy A strategy of choosing representations. It is an
+  ///   optional parameter, which has to be an <code>int</code> type value
+  ///   casted to <code>AbrPolicyEnum</code>.
+  /// @param[in] display_width A width of a display in pixels. It is an
+  ///   optional parameter, which has to be an <code>int</code> type value.
+  /// @param[in] display_height A height of a display in pixels. It is an
+  ///   optional parameter, which has to be an <code>int</code> type value.
   ///
   /// @see kLoadMedia
   /// @see ClipTypeEnum
   void LoadMedia(const pp::Var& type, const pp::Var& url,
                  const pp::Var& subtitle, const pp::Var& encoding,
                  const pp::Var& license_url,
-                 const pp::Var& key_request_properties);
+                 const pp::Var& key_request_properties,
+                 const pp::Var& start_time,
+                 const pp::Var& device_class,
+                 const pp::Var& abr_policy,
+                 const pp::Var& display_width,
+                 const pp::Var& display_height);
+
+  /// @public
+  /// Applies network settings of a <code>kLoadMedia</code> message before
+  /// content is loaded. A previous player is closed first, so its requests
+  /// don't go through a new transport. Settings which aren't given are reset
+  /// to defaults.
+  ///
+  /// @param[in] transport A transport used by requests, <code>"curl"</code>
+  ///   or <code>"socket"</code>. It is an optional parameter, which has to
+  ///   be a <code>string</code> type value. URLLoader is used by default.
+  /// @param[in] segment_cache A budget of a segment cache in megabytes. It
+  ///   is an optional parameter, which has to be an <code>int</code> type
+  ///   value. The cache is disabled by default and while a session is
+  ///   recorded.
+  /// @param[in] parallel_connections A number of connections over which a
+  ///   large segment is downloaded. It is an optional parameter, which has to
+  ///   be an <code>int</code> type value.
+  /// @param[in] network_profile A name of an emulated network profile (see
+  ///   <code>ShapingTransport</code>). It is an optional parameter, which has
+  ///   to be a <code>string</code> type value.
+  /// @param[in] network_trace An emulated bandwidth trace. It is an optional
+  ///   parameter, which has to be a <code>string</code> type value.
+  /// @param[in] record_session A path of a session archive to which network
+  ///   traffic is recorded. It is an optional parameter, which has to be a
+  ///   <code>string</code> type value.
+  /// @param[in] replay_session A path of a session archive which is
+  ///   replayed instead of a network. It is an optional parameter, which has
+  ///   to be a <code>string</code> type value.
+  /// @param[in] replay_time_scale A speed of a replayed session relative to
+  ///   its recording. It is an optional parameter, which has to be a
+  ///   <code>double</code> type value.
+  ///
+  /// @see kLoadMedia
+  void ConfigureNetwork(const pp::Var& transport,
+                        const pp::Var& segment_cache,
+                        const pp::Var& parallel_connections,
+                        const pp::Var& network_profile,
+                        const pp::Var& network_trace,
+                        const pp::Var& record_session,
+                        const pp::Var& replay_session,
+                        const pp::Var& replay_time_scale);
 
   /// @public
   /// Handles a <code>kPause</code> message, and requests the player
@@ -62,7 +62,46 @@ enum MessageToPlayer {
   ///   content with external subtitles this field must be filled.
   /// @param (string)kKeyEncoding [optional] A subtitles encoding code.
   ///   If this parameter is not specified then UTF-8 will be used .
+  /// @param (double)kKeyTime [optional] A playback position (in seconds)
+  ///   at which playback should start. Only DASH content supports this
+  ///   parameter. If it is not specified, playback starts from the beginning.
+  /// @param (int)kKeyDeviceClass [optional] A class of a device, which
+  ///   determines how much memory a playback may use. The only values
+  ///   accepted for this parameter are the ones defined by
+  ///   <code>DeviceClassEnum</code>. If it is not specified, a mid-range
+  ///   device is assumed.
+  /// @param (int)kKeyAbrPolicy [optional] A strategy of choosing a video
+  ///   representation during DASH playback. The only values accepted for
+  ///   this parameter are the ones defined by <code>AbrPolicyEnum</code>.
+  ///   If it is not specified, throughput based selection is used.
+  /// @param (int)kKeyDisplayWidth [optional] A width of a display in pixels.
+  ///   Together with <code>kKeyDisplayHeight</code> it limits a resolution
+  ///   of fetched DASH video representations. If it is not specified, video
+  ///   is limited only by a view rect and a decoder capability.
+  /// @param (int)kKeyDisplayHeight [optional] A height of a display in
+  ///   pixels.
+  /// @param (string)kKeyTransport [optional] A transport used by requests:
+  ///   <code>"curl"</code> or <code>"socket"</code>. If it is not specified,
+  ///   URLLoader is used.
+  /// @param (int)kKeySegmentCache [optional] A budget of a persistent
+  ///   segment cache in megabytes. If it is not specified, the cache is
+  ///   disabled.
+  /// @param (int)kKeyParallelConnections [optional] A number of connections
+  ///   over which a large DASH segment is downloaded. If it is not specified,
+  ///   a single connection is used.
+  /// @param (string)kKeyNetworkProfile [optional] A name of an emulated
+  ///   network profile.
+  /// @param (string)kKeyNetworkTrace [optional] An emulated bandwidth trace.
+  /// @param (string)kKeyRecordSession [optional] A path of a session archive
+  ///   to which network traffic is recorded. A segment cache is disabled
+  ///   while a session is recorded.
+  /// @param (string)kKeyReplaySession [optional] A path of a session archive
+  ///   which is replayed instead of a network.
+  /// @param (double)kKeyReplayTimeScale [optional] A speed of a replayed
+  ///   session relative to its recording, 1 by default.
   /// @see Communication::ClipTypeEnum
+  /// @see Communication::DeviceClassEnum
+  /// @see Communication::AbrPolicyEnum
   kLoadMedia = 1,
 
   /// A request to start playing; no additional parameters.
@@ -80,7 +119,8 @@ enum MessageToPlayer {
   ///   <code>Video = 0</code> or an <code>Audio = 1</code> stream needs
   ///   to be changed.
   /// @param (int)kKeyId An index of a stream representation which should
-  ///   be used.
+  ///   be used. The representation is kept until another one is requested.
+  ///   A negative value restores automatic representation selection.
   kChangeRepresentation = 5,
 
   /// A request to change subtitles representation to a defined one.
@@ -199,6 +239,39 @@ enum class ClipTypeEnum {
   kDash = 2
 };
 
+/// @enum DeviceClassEnum
+/// This enum is used to define a class of a device the player runs on. It is
+/// used in a <code>MessageToPlayer::kLoadMedia</code> message.
+enum class DeviceClassEnum {
+  /// A device class is not known, a mid-range device is assumed.
+  kUnknown = 0,
+
+  /// A device with little memory.
+  kLowEnd = 1,
+
+  /// A typical device.
+  kMidRange = 2,
+
+  /// A device with plenty of memory (e.g. UHD capable).
+  kHighEnd = 3
+};
+
+/// @enum AbrPolicyEnum
+/// This enum is used to define how a representation of a stream is chosen
+/// during playback. It is used in a <code>MessageToPlayer::kLoadMedia</code>
+/// message.
+enum class AbrPolicyEnum {
+  /// A representation is chosen by an estimated network throughput.
+  kThroughput = 0,
+
+  /// A representation is chosen by an amount of buffered media.
+  kBufferBased = 1,
+
+  /// A representation is chosen by planning a few upcoming segments, using
+  /// their actual sizes if a segment index is available.
+  kModelPredictive = 2
+};
+
 /// A string value used in messages as a <code>VarDictionary</code> key.
 /// <code>kKeyMessageToPlayer</code> has to be used in all messages addressed
 /// to the player. The value sent in a field with this key is used to define
@@ -259,6 +332,56 @@ const std::string kKeyWidth = "width";
 /// This key maps to an <code>int</code> type value.
 const std::string kKeyHeight = "height";
 
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to an <code>int</code> type value corresponding to a
+/// DeviceClassEnum value.
+const std::string kKeyDeviceClass = "device_class";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to an <code>int</code> type value corresponding to an
+/// AbrPolicyEnum value.
+const std::string kKeyAbrPolicy = "abr_policy";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to an <code>int</code> type value.
+const std::string kKeyDisplayWidth = "display_width";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to an <code>int</code> type value.
+const std::string kKeyDisplayHeight = "display_height";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to a <code>string</code> type value.
+const std::string kKeyTransport = "transport";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to an <code>int</code> type value.
+const std::string kKeySegmentCache = "segment_cache";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to an <code>int</code> type value.
+const std::string kKeyParallelConnections = "parallel_connections";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to a <code>string</code> type value.
+const std::string kKeyNetworkProfile = "network_profile";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to a <code>string</code> type value.
+const std::string kKeyNetworkTrace = "network_trace";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to a <code>string</code> type value.
+const std::string kKeyRecordSession = "record_session";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to a <code>string</code> type value.
+const std::string kKeyReplaySession = "replay_session";
+
+/// A string value used in messages as a <code>VarDictionary</code> key.
+/// This key maps to a <code>double</code> type value.
+const std::string kKeyReplayTimeScale = "replay_time_scale";
+
 const std::string kDrmLicenseUrl = "drm_license_url";
 const std::string kDrmKeyRequestProperties = "drm_key_request_properties";
 
@@ -0,0 +1,122 @@
+/*!
+ * curl_transport.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_CURL_TRANSPORT_H_
+#define NATIVE_PLAYER_INC_CURL_TRANSPORT_H_
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+
+#include "transport.h"
+
+/// @file
+/// @brief This file defines the <code>CurlTransport</code> class.
+
+/// @class CurlTransport
+/// This class carries out HTTP requests with libcurl, as an alternative to
+/// <code>pp::URLLoader</code> (see <code>SetTransportType()</code>).
+/// Compressed responses are passed on as they are received.
+///
+/// All requests share one libcurl multi handle, so connections to a host are
+/// kept alive and reused by subsequent segment, index and license requests.
+/// Requests are made by blocking calls from side threads. Instead of a
+/// dedicated network thread, one of the waiting callers drives all transfers
+/// at a time, so data of a request can be passed to its callback on a thread
+/// of another request. A caller is blocked until its request finishes, so
+/// its callback is never called concurrently with the caller.
+///
+/// All methods of this class are thread safe.
+class CurlTransport : public Transport {
+ public:
+  /// Settings of transfers. Timeouts are given in milliseconds.
+  struct Config {
+    Config()
+        : connect_timeout_ms(5000),
+          low_speed_limit(1024),
+          low_speed_time_ms(10000),
+          max_host_connections(4),
+          max_total_connections(16) {}
+
+    /// A time allowed for a name lookup and a connection.
+    int32_t connect_timeout_ms;
+    /// A transfer is failed if it's slower than <code>low_speed_limit</code>
+    /// (in bytes per second) for <code>low_speed_time_ms</code>.
+    int32_t low_speed_limit;
+    int32_t low_speed_time_ms;
+    /// Limits of simultaneously open connections.
+    int32_t max_host_connections;
+    int32_t max_total_connections;
+    /// A certificate bundle used to verify HTTPS peers, a libcurl default is
+    /// used if it's empty.
+    std::string ca_bundle_path;
+  };
+
+  /// Returns a transport shared by all requests.
+  static CurlTransport& GetInstance();
+
+  /// Changes settings of transfers. Requests already started keep settings
+  /// they started with.
+  void SetConfig(const Config& config);
+
+  /// Carries out a request, passing a response body to a callback as it's
+  /// received. Must be called on a side thread.
+  ///
+  /// @param[in] request A request to carry out.
+  /// @param[in] on_data A callback called with each piece of received data.
+  ///   A request is aborted if it returns <code>false</code>.
+  /// @param[out] response A status code and timing of a transfer.
+  ///
+  /// @return <code>PP_OK</code> on success, <code>PP_ERROR_ABORTED</code> if
+  ///   a callback aborted a request, <code>PP_ERROR_TIMEDOUT</code> if a
+  ///   transfer timed out or <code>PP_ERROR_FAILED</code> otherwise.
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+
+  bool AcceptsCompressedResponses() const override { return true; }
+
+ private:
+  struct Transfer;
+
+  CurlTransport();
+  ~CurlTransport() override;
+
+  CurlTransport(const CurlTransport&) = delete;
+  CurlTransport& operator=(const CurlTransport&) = delete;
+
+  // Drives all transfers until a given one is done. Must be called with
+  // mutex_ locked by a caller which became a driver.
+  void DriveTransfers(Transfer* own_transfer,
+                      std::unique_lock<std::mutex>* lock);
+
+  static size_t OnHeader(char* data, size_t size, size_t count, void* user);
+  static size_t OnData(char* data, size_t size, size_t count, void* user);
+
+  // A CURLM handle, libcurl headers aren't exposed here.
+  void* multi_handle_;
+  Config config_;
+  bool multi_config_pending_;
+
+  std::mutex mutex_;
+  std::condition_variable transfer_done_;
+  // Transfers waiting to be added to a multi handle by a driver.
+  std::list<Transfer*> new_transfers_;
+  bool driving_;
+};
+
+#endif  // NATIVE_PLAYER_INC_CURL_TRANSPORT_H_
@@ -23,6 +23,8 @@
 #include <memory>
 #include <vector>
 
+#include "common.h"
+
 /// @file
 /// @brief This file defines <code>MediaSegmentSequence</code> class.
 
@@ -45,6 +47,7 @@ class MediaSegmentSequence {
  public:
   static constexpr double kInvalidSegmentDuration = -1.0;
   static constexpr double kInvalidSegmentTimestamp = -1.0;
+  static constexpr int64_t kUnknownSegmentSize = -1;
 
   virtual ~MediaSegmentSequence();
 
@@ -122,6 +125,11 @@ class MediaSegmentSequence {
     /// (like invalid MediaSegmentSequence).
     double SegmentTimestamp(const MediaSegmentSequence*) const;
 
+    /// Provides a segment size for the given MediaSegmentSequence.
+    /// @return Segment size in bytes.\n Value < 0 if the size isn't known
+    /// before the segment is downloaded (e.g. no segment index is available).
+    int64_t SegmentSize(const MediaSegmentSequence*) const;
+
    private:
     std::unique_ptr<SequenceIterator> pimpl_;
   };
@@ -174,6 +182,13 @@ class MediaSegmentSequence {
   /// (like invalid iterator, passed iterator doesn't points to current
   /// sequence).
   virtual double SegmentTimestamp(const Iterator& it) const;
+
+  /// Provides a segment size for the given Iterator. A size is known in
+  /// advance for sequences with a segment index (i.e. SegmentBase with a
+  /// sidx box).
+  /// @return Segment size in bytes.\n Value < 0 if the size is unknown or in
+  /// case of error (like invalid iterator).
+  virtual int64_t SegmentSize(const Iterator& it) const;
 };
 
 /// Downloads the whole segment to the vector pointed by data for the given
@@ -185,6 +200,66 @@ class MediaSegmentSequence {
 /// ISegment).
 bool DownloadSegment(dash::mpd::ISegment* seg, std::vector<uint8_t>* data);
 
+/// Downloads the whole segment to the vector pointed by data for the given
+/// segment, reporting download progress.
+///
+/// @param[in] seg An ISegment for which data will be downloaded.
+/// @param[out] data An array container to which data will be downloaded.
+/// @param[in] progress A callback called as data is received. A download is
+///   aborted if it returns <code>false</code>. While an interrupted download
+///   waits to be resumed, it's called periodically with no new data.
+/// @param[out] cached If given, it's set if data was read from a segment
+///   cache (see <code>SegmentCache</code>) instead of downloaded.
+/// @return True if download succeed.\n False if download fails or is
+/// aborted.
+bool DownloadSegment(dash::mpd::ISegment* seg, std::vector<uint8_t>* data,
+                     const DownloadProgressCallback& progress,
+                     bool* cached = nullptr);
+
+/// Downloads the segment for the given segment, passing its data to a
+/// callback piece by piece as it is received. If the same segment is being
+/// downloaded by another request already, whole data is passed at once when
+/// it is complete.
+///
+/// @param[in] seg An ISegment for which data will be downloaded.
+/// @param[in] on_data A callback called with each piece of received data. A
+///   download is aborted if it returns <code>false</code>. While a download
+///   of another request is waited for or an interrupted download waits to
+///   be resumed, it's called periodically with no data.
+/// @param[out] cached If given, it's set if data was read from a segment
+///   cache instead of downloaded.
+/// @param[out] segment_data If given, whole data of a segment is gathered in
+///   it, e.g. to be kept in memory. The same buffer is stored in a segment
+///   cache, so data isn't gathered twice.
+/// @return True if download succeed.\n False if download fails or is
+/// aborted.
+bool StreamSegment(dash::mpd::ISegment* seg,
+                   const DownloadDataCallback& on_data,
+                   bool* cached = nullptr,
+                   std::vector<uint8_t>* segment_data = nullptr);
+
+/// Downloads a part of the segment, passing its data to a callback piece by
+/// piece as it is received. Parts of a segment can be downloaded in parallel
+/// over separate connections. A segment cache isn't used.
+///
+/// @param[in] seg An ISegment for which data will be downloaded.
+/// @param[in] offset A first byte of a part, counted from a beginning of a
+///   segment.
+/// @param[in] size A size of a part in bytes, or -1 to download a segment to
+///   its end.
+/// @param[in] on_data A callback called with each piece of received data. A
+///   download is aborted if it returns <code>false</code>. While an
+///   interrupted download waits to be resumed, it's called periodically with
+///   no data.
+/// @param[out] range_ignored If given, it's set before any data is passed to
+///   a callback if a server doesn't support byte ranges, i.e. it sends a
+///   whole resource instead of a requested part.
+/// @return True if download succeed.\n False if download fails or is
+/// aborted.
+bool StreamSegmentPart(dash::mpd::ISegment* seg, uint64_t offset, int64_t size,
+                       const DownloadDataCallback& on_data,
+                       bool* range_ignored = nullptr);
+
 /// Downloads whole segment to vector pointed by data for given segment.
 /// @note This method calls  <code>DownloadSegment(dash::mpd::ISegment* seg,
 /// std::vector<uint8_t>* data)</code>
@@ -0,0 +1,55 @@
+/*!
+ * file_transport.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_FILE_TRANSPORT_H_
+#define NATIVE_PLAYER_INC_FILE_TRANSPORT_H_
+
+#include <string>
+
+#include "transport.h"
+
+/// @file
+/// @brief This file defines the <code>FileTransport</code> class.
+
+/// @class FileTransport
+/// This class serves requests from local files instead of a network, e.g. to
+/// play content stored on a disk or to run a player against a local copy of
+/// a stream.
+///
+/// <code>file://</code> URLs are mapped to absolute paths. If a root
+/// directory is given, a path of an <code>http://</code> or
+/// <code>https://</code> URL is mapped to a file in that directory, so an
+/// MPD with absolute URLs can be served from a mirrored directory tree.
+/// Byte ranges are supported and only <code>GET</code> requests are served.
+class FileTransport : public Transport {
+ public:
+  /// @param[in] root_directory A directory to which paths of HTTP URLs are
+  ///   mapped. If it's empty, only <code>file://</code> URLs are served.
+  explicit FileTransport(const std::string& root_directory = std::string());
+
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+
+ private:
+  // Returns a path of a file a URL is mapped to, or an empty string if a URL
+  // can't be served.
+  std::string PathForURL(const std::string& url) const;
+
+  std::string root_directory_;
+};
+
+#endif  // NATIVE_PLAYER_INC_FILE_TRANSPORT_H_
@@ -0,0 +1,153 @@
+/*!
+ * memory_governor.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_MEMORY_GOVERNOR_H_
+#define NATIVE_PLAYER_INC_MEMORY_GOVERNOR_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+/// @file
+/// @brief This file defines the <code>MemoryGovernor</code> and
+/// <code>MemoryAccount</code> classes.
+
+/// @enum DeviceClass
+/// A class of a device the player runs on. It determines resources available
+/// to a playback session.
+enum class DeviceClass {
+  kUnknown = 0,
+  kLowEnd,
+  kMidRange,
+  kHighEnd,
+};
+
+/// @class MemoryGovernor
+/// This class accounts media data buffered in a playback pipeline against a
+/// session-wide byte budget.
+///
+/// Every pipeline component that holds media data registers its usage with
+/// the governor (see <code>MemoryAccount</code>). Components which produce
+/// data (i.e. segment downloads and demuxers) check
+/// <code>IsOverBudget()</code> before they produce more and back off if the
+/// budget is exceeded.
+///
+/// All methods of this class are thread safe.
+class MemoryGovernor {
+ public:
+  /// @enum Component
+  /// Pipeline components which hold media data.
+  enum Component {
+    /// Downloaded media segments waiting to be demuxed.
+    kSegmentData = 0,
+    /// Data passed to a demuxer and not parsed yet.
+    kDemuxerInput,
+    /// Demuxer I/O buffers.
+    kDemuxerIoBuffer,
+    /// Elementary stream packets waiting to be appended to NaCl Player.
+    kPacketQueue,
+    /// Recently downloaded segments kept for back-seeks and switch-backs.
+    /// This memory is released first when usage exceeds a budget.
+    kSegmentCache,
+    /// Idle segment buffers kept for reuse by following downloads.
+    kSegmentBufferPool,
+    kComponentCount
+  };
+
+  /// Returns the governor shared by all pipeline components.
+  static MemoryGovernor& GetInstance();
+
+  /// Returns a default budget for a given device class.
+  static size_t BudgetForDeviceClass(DeviceClass device_class);
+
+  /// Sets a budget to a default for a given device class.
+  void SetDeviceClass(DeviceClass device_class);
+
+  /// Sets a budget in bytes.
+  void SetBudget(size_t bytes);
+
+  size_t Budget() const { return budget_; }
+
+  /// Registers <code>bytes</code> more bytes held by a
+  /// <code>component</code>.
+  void Add(Component component, size_t bytes);
+
+  /// Unregisters <code>bytes</code> bytes held by a <code>component</code>.
+  void Release(Component component, size_t bytes);
+
+  size_t Usage(Component component) const { return usage_[component]; }
+
+  size_t TotalUsage() const { return total_usage_; }
+
+  /// Checks if media data held by all components exceeds a budget.
+  bool IsOverBudget() const { return total_usage_ > budget_; }
+
+  /// Blocks a calling thread until usage drops below a budget or a given
+  /// <code>timeout</code> passes. This must not be called on a thread which
+  /// releases memory (e.g. the main thread).
+  ///
+  /// @return <code>true</code> if usage is below a budget, <code>false</code>
+  ///   if the wait timed out.
+  bool WaitForBudget(std::chrono::milliseconds timeout);
+
+  /// Logs usage of each component and peak usage. A report is logged at most
+  /// once every few seconds, so this can be called from a playback loop.
+  void ReportUsage();
+
+ private:
+  MemoryGovernor();
+
+  std::array<std::atomic<size_t>, kComponentCount> usage_;
+  std::atomic<size_t> total_usage_;
+  std::atomic<size_t> peak_usage_;
+  std::atomic<size_t> budget_;
+
+  std::mutex budget_mutex_;
+  std::condition_variable budget_condition_;
+  std::chrono::steady_clock::time_point last_report_;
+};
+
+/// @class MemoryAccount
+/// This class registers a size of a single buffer with
+/// <code>MemoryGovernor</code>. A registered size is released when the
+/// account is destroyed, so an account should be a member of an object which
+/// owns the buffer.
+class MemoryAccount {
+ public:
+  explicit MemoryAccount(MemoryGovernor::Component component)
+      : component_(component),
+        bytes_(0) {}
+  ~MemoryAccount() { Set(0); }
+
+  MemoryAccount(const MemoryAccount&) = delete;
+  MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+  /// Updates a size of an accounted buffer.
+  void Set(size_t bytes);
+
+  size_t bytes() const { return bytes_; }
+
+ private:
+  MemoryGovernor::Component component_;
+  size_t bytes_;
+};
+
+#endif  // NATIVE_PLAYER_INC_MEMORY_GOVERNOR_H_
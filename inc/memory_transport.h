@@ -0,0 +1,57 @@
+/*!
+ * memory_transport.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_MEMORY_TRANSPORT_H_
+#define NATIVE_PLAYER_INC_MEMORY_TRANSPORT_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "transport.h"
+
+/// @file
+/// @brief This file defines the <code>MemoryTransport</code> class.
+
+/// @class MemoryTransport
+/// This class serves requests from resources held in memory, e.g. fixtures
+/// of a benchmark. A resource is served for a URL regardless of a request
+/// method, so a license request can be answered too. Byte ranges are
+/// supported.
+///
+/// All methods of this class are thread safe.
+class MemoryTransport : public Transport {
+ public:
+  /// Adds a resource served for a given URL, replacing a previous one.
+  void AddResource(const std::string& url, std::vector<uint8_t> data);
+
+  void RemoveResource(const std::string& url);
+
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+
+ private:
+  std::mutex mutex_;
+  // Resources are shared with requests, so they can be served without
+  // holding mutex_.
+  std::unordered_map<std::string, std::shared_ptr<const std::vector<uint8_t>>>
+      resources_;
+};
+
+#endif  // NATIVE_PLAYER_INC_MEMORY_TRANSPORT_H_
@@ -0,0 +1,40 @@
+/*!
+ * pepper_transport.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_PEPPER_TRANSPORT_H_
+#define NATIVE_PLAYER_INC_PEPPER_TRANSPORT_H_
+
+#include "transport.h"
+
+/// @file
+/// @brief This file defines the <code>PepperTransport</code> class.
+
+/// @class PepperTransport
+/// This class carries out HTTP requests with <code>pp::URLLoader</code> of a
+/// browser. It's a default transport (see <code>SetTransport()</code>).
+///
+/// Requests must be made from side threads with a
+/// <code>pp::MessageLoop</code> attached. A browser decompresses responses
+/// on its own and only reports a time to a first byte and a total time of a
+/// transfer.
+class PepperTransport : public Transport {
+ public:
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+};
+
+#endif  // NATIVE_PLAYER_INC_PEPPER_TRANSPORT_H_
@@ -22,6 +22,8 @@
 #define NATIVE_PLAYER_INC_PLAYER_ES_DASH_PLAYER_ES_DASH_PLAYER_CONTROLLER_H_
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -35,6 +37,7 @@
 #include "ppapi/utility/threading/simple_thread.h"
 
 #include "common.h"
+#include "memory_governor.h"
 #include "dash/dash_manifest.h"
 #include "player/es_dash_player/packets_manager.h"
 #include "player/es_dash_player/stream_manager.h"
@@ -42,6 +45,9 @@
 #include "player/player_listeners.h"
 #include "communicator/message_sender.h"
 
+class AbrController;
+class BandwidthEstimator;
+class BandwidthHistory;
 class DrmPlayReadyListener;
 
 /// @file
@@ -101,12 +107,22 @@ class EsDashPlayerController : public PlayerController,
         subtitles_visible_(true),
         seeking_(false),
         media_duration_(0.),
+        start_time_(0.),
         message_sender_(message_sender),
-        state_(PlayerState::kUnitialized) {}
+        state_(PlayerState::kUnitialized),
+        device_class_(DeviceClass::kUnknown),
+        display_width_(0),
+        display_height_(0),
+        view_width_(0),
+        view_height_(0),
+        abr_policy_(AbrPolicyType::kThroughput),
+        index_loading_cancelled_(false),
+        current_representations_(),
+        representation_pinned_() {}
 
   /// Destroys an <code>EsDashPlayerController</code> object. This also
   /// destroys a <code>MediaPlayer</code> object and thus a player pipeline.
-  ~EsDashPlayerController() override {};
+  ~EsDashPlayerController() override;
 
   /// Initializes NaCl Player and prepares it to play a given content.
   /// Subtitles information may also be passed to this function to get ready
@@ -130,6 +146,14 @@ class EsDashPlayerController : public PlayerController,
   /// @param[in] drm_key_request_properties HTTP/HTTPS request header elements
   ///   used when requesting license from license server
   ///   (see <code>drm_license_url</code>).
+  /// @param[in] start_time A playback position at which playback should
+  ///   start. Streams are initialized directly at a segment containing this
+  ///   position, so no additional seek is needed to resume playback.
+  /// @param[in] device_class A class of a device the player runs on. It
+  ///   determines how much media data may be buffered (see
+  ///   <code>MemoryGovernor</code>).
+  /// @param[in] abr_policy A strategy of choosing a video representation
+  ///   during playback.
   ///
   /// @see EsDashPlayerController::EsDashPlayerController()
   /// @see MessageSender::ShowSubtitles()
@@ -137,7 +161,16 @@ class EsDashPlayerController : public PlayerController,
                   const std::string& encoding,
                   const std::string& drm_license_url,
                   const std::unordered_map<std::string, std::string>&
-                          drm_key_request_properties);
+                          drm_key_request_properties,
+                  Samsung::NaClPlayer::TimeTicks start_time = 0.,
+                  DeviceClass device_class = DeviceClass::kUnknown,
+                  AbrPolicyType abr_policy = AbrPolicyType::kThroughput);
+
+  /// Sets a resolution of a display, in pixels. Video representations above
+  /// it aren't fetched. A resolution is unknown by default, so
+  /// representations are capped only by a view rect and a decoder
+  /// capability.
+  void SetDisplayResolution(uint32_t width, uint32_t height);
 
   // Overloaded methods defined by PlayerController, don't have to be commented
   void Play() override;
@@ -176,6 +209,30 @@ class EsDashPlayerController : public PlayerController,
 
   void OnChangeRepresentation(int32_t /*result*/, StreamType type, int32_t id);
 
+  /// @public
+  /// Handles a representation change requested by a user. A chosen
+  /// representation is kept until the user requests another one, a negative
+  /// <code>id</code> restores automatic representation selection.
+  void OnRepresentationRequest(int32_t /*result*/, StreamType type,
+                               int32_t id);
+
+  /// @public
+  /// Lets <code>AbrController</code> choose a video representation for a next
+  /// media segment. This should be called before the segment is requested.
+  ///
+  /// @param[in] playback_time A current playback time.
+  void AdaptVideoRepresentation(Samsung::NaClPlayer::TimeTicks playback_time);
+
+  /// @public
+  /// Re-evaluates a resolution cap of video representations after a view
+  /// rect changed, and switches a representation if a current one exceeds a
+  /// new cap.
+  ///
+  /// @param[in] view_width A width of a new view rect.
+  /// @param[in] view_height A height of a new view rect.
+  void UpdateResolutionCap(int32_t /*result*/, uint32_t view_width,
+                           uint32_t view_height);
+
   /// @public
   /// Loads a subtitles file. This will enable subtitle text updates to be sent
   /// to the UI module using the <code>MessageSender</code> class during
@@ -206,12 +263,36 @@ class EsDashPlayerController : public PlayerController,
   ///   PP_OK is an expected value.
   void InitializeStreams(int32_t /*result*/);
 
+  /// @public
+  /// Moves NaCl Player to <code>start_time_</code> after a data source is
+  /// attached. Stream managers are already positioned at that time, so this
+  /// doesn't reset them like a regular <code>Seek()</code> does.
+  void SeekToStartTime();
+
   void InitializeVideoStream(Samsung::NaClPlayer::DRMType /*drm_type*/);
 
   void InitializeAudioStream(Samsung::NaClPlayer::DRMType /*drm_type*/);
 
   void OnSetDisplayRect(int32_t /*result*/);
 
+  /// @public
+  /// Loads a segment index of a video representation. This runs on
+  /// <code>index_thread_</code> and passes a loaded sequence to
+  /// <code>OnVideoSegmentIndexLoaded()</code> on a given message loop.
+  ///
+  /// @param[in] id An id of a video representation.
+  /// @param[in] destination A message loop of the player thread.
+  void LoadVideoSegmentIndex(int32_t /*result*/, uint32_t id,
+                             pp::MessageLoop destination);
+
+  /// @public
+  /// Makes a loaded segment index available to <code>video_abr_</code>.
+  ///
+  /// @param[in] id An id of a video representation.
+  /// @param[in] sequence A loaded sequence, owned by this method.
+  void OnVideoSegmentIndexLoaded(int32_t /*result*/, uint32_t id,
+                                 MediaSegmentSequence* sequence);
+
   void OnSeek(int32_t /*result*/);
 
   void OnChangeSubtitles(int32_t /*result*/, int32_t id);
@@ -237,6 +318,11 @@ class EsDashPlayerController : public PlayerController,
   bool seeking_;
   Samsung::NaClPlayer::TimeTicks media_duration_;
 
+  /// A playback position requested in <code>InitPlayer()</code>, aligned to
+  /// a video keyframe once streams are initialized. Until NaCl Player reaches
+  /// it, this is used as a current playback time.
+  Samsung::NaClPlayer::TimeTicks start_time_;
+
   std::shared_ptr<Communication::MessageSender> message_sender_;
 
   PlayerState state_;
@@ -257,6 +343,41 @@ class EsDashPlayerController : public PlayerController,
   std::string drm_license_url_;
   std::unordered_map<std::string, std::string> drm_key_request_properties_;
 
+  /// Estimates network throughput from media segment downloads of all
+  /// streams.
+  std::shared_ptr<BandwidthEstimator> bandwidth_estimator_;
+  /// Bandwidth estimates of previous sessions, per a host of a manifest.
+  std::unique_ptr<BandwidthHistory> bandwidth_history_;
+  std::string media_host_;
+  std::chrono::steady_clock::time_point last_bandwidth_record_;
+  DeviceClass device_class_;
+  /// A resolution of a display, zero if unknown.
+  uint32_t display_width_;
+  uint32_t display_height_;
+  /// A size of <code>view_rect_</code> as seen by the player thread, which
+  /// must not read <code>view_rect_</code> itself.
+  uint32_t view_width_;
+  uint32_t view_height_;
+  AbrPolicyType abr_policy_;
+  std::unique_ptr<AbrController> video_abr_;
+  /// Sequences of all video representations, which let
+  /// <code>video_abr_</code> know sizes of upcoming segments. They are loaded
+  /// only for a policy which looks ahead, in the background (see
+  /// <code>index_thread_</code>).
+  std::unordered_map<int32_t, std::unique_ptr<MediaSegmentSequence>>
+      video_index_sequences_;
+  /// Loads <code>video_index_sequences_</code>, as each one may need a
+  /// segment index to be downloaded.
+  std::unique_ptr<pp::SimpleThread> index_thread_;
+  /// Set to skip segment indexes not loaded yet when a player is cleaned.
+  std::atomic<bool> index_loading_cancelled_;
+  std::array<int32_t, static_cast<size_t>(StreamType::MaxStreamTypes)>
+      current_representations_;
+  /// Representations chosen by a user aren't changed by
+  /// <code>video_abr_</code>.
+  std::array<bool, static_cast<size_t>(StreamType::MaxStreamTypes)>
+      representation_pinned_;
+
   class Impl;
   friend class Impl;
 };
@@ -202,8 +202,8 @@ class PacketsManager : public StreamListener {
   /// EOS is in effect when EOS count reaches number of streams.
   int eos_count_;
 
-  std::array<bool,
-            static_cast<int32_t>(StreamType::MaxStreamTypes)> seek_segment_set_;
+  /// A start of a video segment containing a seek target, determined in
+  /// <code>PrepareForSeek()</code>. Audio seek is aligned to this time.
   Samsung::NaClPlayer::TimeTicks seek_segment_video_time_;
 
   std::array<Samsung::NaClPlayer::TimeTicks,
@@ -37,6 +37,7 @@
 #include "demuxer/stream_demuxer.h"
 #include "player/es_dash_player/stream_listener.h"
 
+class BandwidthEstimator;
 class ElementaryStreamPacket;
 
 /// @file
@@ -119,6 +120,10 @@ class StreamManager : public Samsung::NaClPlayer::ElementaryStreamListener {
   ///   <code>ElementaryStreamPacket</code>s outputted from this stream.
   /// @param[in] drm_type A DRM scheme used by the managed stream. If no DRM
   ///   is in use, use <code>Samsung::NaClPlayer::DRMType_Unknown</code>.
+  /// @param[in] start_time A playback position from which media segments
+  ///   will be downloaded. If it's not zero, NaCl Player is expected to seek
+  ///   to this position once a data source is attached (see
+  ///   <code>IsStartPositionPending()</code>).
   ///
   /// @return <code>true</code> if an initialization was successfull, or
   ///   <code>false</code> otherwise.
@@ -130,14 +135,18 @@ class StreamManager : public Samsung::NaClPlayer::ElementaryStreamListener {
           ElementaryStreamPacket>)> es_packet_callback,
       StreamListener* stream_listener,
       Samsung::NaClPlayer::DRMType drm_type =
-          Samsung::NaClPlayer::DRMType_Unknown);
+          Samsung::NaClPlayer::DRMType_Unknown,
+      Samsung::NaClPlayer::TimeTicks start_time = 0.);
 
   void SetDrmInitData(const std::string& type,
                       const std::vector<uint8_t>& init_data);
 
   /// Changes a <code>MediaSegmentSequence</code> object associated with this
-  /// stream. This method resets internal demuxer to parse a given new media
-  /// segment, usually causing a change in a stream configuration.
+  /// stream. Segments already downloaded or being downloaded are played as
+  /// they are. The new sequence is used starting from a next segment boundary,
+  /// where a new internal demuxer takes over from a previous one after it
+  /// delivers all of its packets. A stream configuration is changed only if
+  /// codec parameters of the new representation differ.
   ///
   /// This method allows to change a representation of this media stream by
   /// providing a <code>MediaSegmentSequence</code> of the new representation.
@@ -158,6 +167,45 @@ class StreamManager : public Samsung::NaClPlayer::ElementaryStreamListener {
   /// @return Indicates whether there are more segments to download or not.
   bool UpdateBuffer(Samsung::NaClPlayer::TimeTicks playback_time);
 
+  /// Checks if a next call to <code>UpdateBuffer()</code> with the same
+  /// <code>playback_time</code> will request a media segment download. This
+  /// allows to choose a representation before the segment is requested.
+  ///
+  /// @param[in] playback_time A current playback time.
+  ///
+  /// @return A <code>true</code> value if a segment download is due, or a
+  ///   <code>false</code> otherwise.
+  bool IsSegmentRequestDue(Samsung::NaClPlayer::TimeTicks playback_time) const;
+
+  /// Returns a time of media segments downloaded (or being downloaded) ahead
+  /// of a given <code>playback_time</code>, in seconds.
+  ///
+  /// @param[in] playback_time A current playback time.
+  Samsung::NaClPlayer::TimeTicks GetBufferLevel(
+      Samsung::NaClPlayer::TimeTicks playback_time) const;
+
+  /// Makes this stream report a size and a download time of each downloaded
+  /// media segment to a given <code>estimator</code>.
+  ///
+  /// @param[in] estimator An estimator shared by all streams of a player.
+  void SetBandwidthEstimator(std::shared_ptr<BandwidthEstimator> estimator);
+
+  /// Enables or disables abandoning segment downloads. If enabled, a download
+  /// is abandoned as soon as it's projected to finish after data buffered at
+  /// the time of a request runs out. An abandoned segment is requested again
+  /// on a next <code>UpdateBuffer()</code> call, from a representation set
+  /// in the meantime.
+  ///
+  /// @param[in] enabled Whether downloads may be abandoned.
+  void SetSegmentAbandonment(bool enabled);
+
+  /// Checks if a last segment download was abandoned, i.e. a next segment
+  /// request repeats it. This is reset when a next segment is requested.
+  ///
+  /// @return A <code>true</code> value if a last download was abandoned, or a
+  ///   <code>false</code> otherwise.
+  bool IsLastSegmentAbandoned() const;
+
   /// Checks if this <code>StreamManager</code> was initialized, i.e.
   /// <code>Initialize()</code> was successfully called on this object before
   /// and thus internal demuxer is properly initialized.
@@ -168,6 +216,15 @@ class StreamManager : public Samsung::NaClPlayer::ElementaryStreamListener {
 
   bool IsSeeking() const;
 
+  /// Checks if this stream was initialized at a non-zero start time and NaCl
+  /// Player didn't reach that position yet (i.e. <code>OnSeekData()</code>
+  /// for the start position didn't occur). Packets must not be appended to
+  /// the stream until then.
+  ///
+  /// @return A <code>true</code> value if a start position is pending, or a
+  ///   <code>false</code> otherwise.
+  bool IsStartPositionPending() const;
+
   /// Prepares this <code>StreamManager</code> for a seek operation. This
   /// stops the manager from downloading media segments from an old playback
   /// position and initiates download of media segments starting at a
@@ -190,6 +247,19 @@ class StreamManager : public Samsung::NaClPlayer::ElementaryStreamListener {
   Samsung::NaClPlayer::TimeTicks GetClosestKeyframeTime(
       Samsung::NaClPlayer::TimeTicks);
 
+  /// Looks up a segment index of the current representation and returns a
+  /// start time of a media segment which contains a given <code>time</code>.
+  /// Unlike <code>SetSegmentToTime()</code>, this doesn't change the next
+  /// segment to be downloaded, so it can be used to determine a seek target
+  /// before <code>OnSeekData()</code> event occurs.
+  ///
+  /// @param[in] time A playback position to look up.
+  ///
+  /// @return A start time of a segment containing <code>time</code>, or
+  ///   <code>time</code> itself if no such segment exists.
+  Samsung::NaClPlayer::TimeTicks GetSegmentStartTime(
+      Samsung::NaClPlayer::TimeTicks time);
+
  private:
   void OnNeedData(int32_t bytes_max) override;
   void OnEnoughData() override;
@@ -27,6 +27,7 @@
 #include "ppapi/cpp/instance.h"
 
 #include "common.h"
+#include "memory_governor.h"
 #include "player/player_controller.h"
 #include "communicator/message_sender.h"
 
@@ -101,6 +102,16 @@ class PlayerProvider {
   /// @param[in] drm_key_request_properties HTTP/HTTPS request header elements
   ///   used when requesting license from license server
   ///   (see <code>drm_license_url</code>).
+  /// @param[in] start_time A playback position at which playback should
+  ///   start. Currently only <code>kEsDash</code> player supports starting
+  ///   playback at an offset, other players ignore this parameter.
+  /// @param[in] device_class A class of a device the player runs on. It
+  ///   determines a memory budget of a <code>kEsDash</code> player.
+  /// @param[in] abr_policy A strategy of choosing representations by a
+  ///   <code>kEsDash</code> player.
+  /// @param[in] display_rect A size of a display. An empty rect means the
+  ///   size is unknown. A <code>kEsDash</code> player doesn't fetch video
+  ///   representations exceeding it.
   ///
   /// @return A configured and initialized <code>PlayerController<code>.
   std::shared_ptr<PlayerController> CreatePlayer(PlayerType type,
@@ -110,7 +121,12 @@ class PlayerProvider {
       const std::string& encoding,
       const std::string& drm_license_url,
       const std::unordered_map<std::string, std::string>&
-            drm_key_request_properties);
+            drm_key_request_properties,
+      Samsung::NaClPlayer::TimeTicks start_time = 0.,
+      DeviceClass device_class = DeviceClass::kUnknown,
+      AbrPolicyType abr_policy = AbrPolicyType::kThroughput,
+      const Samsung::NaClPlayer::Rect& display_rect =
+          Samsung::NaClPlayer::Rect());
 
  private:
   pp::InstanceHandle instance_;
@@ -0,0 +1,161 @@
+/*!
+ * session_archive.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_SESSION_ARCHIVE_H_
+#define NATIVE_PLAYER_INC_SESSION_ARCHIVE_H_
+
+#include <stdio.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "transport.h"
+
+/// @file
+/// @brief This file defines the <code>RecordingTransport</code> and
+/// <code>ReplayTransport</code> classes, which write and read a session
+/// archive.
+///
+/// A session archive is a single file holding responses to all requests of
+/// a playback session (i.e. an MPD, segment indexes, initialization and
+/// media segments and license responses) along with their timing. Response
+/// bodies are followed by an index, which is rewritten after each recorded
+/// response, so an archive is complete even if a session ends abruptly.
+///
+/// Paths under <code>kPersistentStoragePath</code> are stored in a
+/// persistent storage, which is mounted when an archive is first used.
+
+/// @struct SessionArchiveEntry
+/// An index entry of a response recorded in a session archive.
+struct SessionArchiveEntry {
+  /// A request method, URL and byte range (see <code>Range</code> header).
+  std::string key;
+  int32_t status_code;
+  /// A result of a transfer, <code>PP_OK</code> or an error a transfer
+  /// failed with after a part of a body was received.
+  int32_t result;
+  /// An offset of a response body in an archive.
+  uint64_t offset;
+  uint64_t size;
+  /// Times (in seconds) from a start of a request until a first and a last
+  /// byte of a response was received.
+  double first_byte;
+  double total;
+};
+
+/// @class RecordingTransport
+/// This class records every response of another transport to a session
+/// archive. A response is recorded with a request method, URL and byte
+/// range, a status code, a body as it was received, times of its first and
+/// last byte and a result of a transfer. A transfer which failed is recorded
+/// with a part of a body received before it failed, so a request resumed
+/// after it (e.g. with a <code>Range</code> header) is replayed the same way.
+/// Transfers aborted by a caller aren't recorded.
+///
+/// Responses served by a persistent segment cache don't reach a transport,
+/// so the cache should be disabled while a session is recorded (see
+/// <code>SegmentCache::SetBudget()</code>).
+///
+/// All methods of this class are thread safe.
+class RecordingTransport : public Transport {
+ public:
+  /// @param[in] transport A transport which carries out requests.
+  /// @param[in] path A path of an archive. An existing file is replaced.
+  RecordingTransport(std::shared_ptr<Transport> transport,
+                     const std::string& path);
+  ~RecordingTransport() override;
+
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+
+  bool AcceptsCompressedResponses() const override {
+    return transport_->AcceptsCompressedResponses();
+  }
+
+ private:
+  // Appends a response and rewrites an index after it. Must be called with
+  // mutex_ held.
+  bool Append(const std::string& key, int32_t status_code, int32_t result,
+              const std::vector<uint8_t>& body, double first_byte,
+              double total);
+
+  std::shared_ptr<Transport> transport_;
+  std::string path_;
+
+  std::mutex mutex_;
+  FILE* file_;
+  // Set once opening an archive failed, so recording stops.
+  bool failed_;
+  std::vector<SessionArchiveEntry> index_;
+  // An offset at which a next response is written.
+  uint64_t data_end_;
+};
+
+/// @class ReplayTransport
+/// This class serves responses recorded in a session archive instead of
+/// using a network.
+///
+/// A request is matched by its method, URL and byte range. Responses to
+/// repeated requests (e.g. MPD updates or license requests, whose bodies
+/// differ between sessions) are served in an order they were recorded and
+/// the last of them is served once all were used. A byte range which wasn't
+/// recorded is cut from a recorded whole resource. A recorded failure is
+/// replayed: a part of a body received before it is passed on and a request
+/// fails with a recorded error. Requests which weren't recorded fail with
+/// <code>PP_ERROR_FILENOTFOUND</code>.
+///
+/// A response is delivered with its recorded timing multiplied by a time
+/// scale. A scale of 0 serves responses as fast as possible.
+///
+/// All methods of this class are thread safe.
+class ReplayTransport : public Transport {
+ public:
+  /// @param[in] path A path of an archive.
+  /// @param[in] time_scale A multiplier of recorded response times.
+  explicit ReplayTransport(const std::string& path, double time_scale = 1.);
+  ~ReplayTransport() override;
+
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+
+  bool AcceptsCompressedResponses() const override { return true; }
+
+ private:
+  // Reads an index of an archive once. Must be called with mutex_ held.
+  bool Open();
+
+  // Finds a response recorded for a given key and reads its body. Must be
+  // called with mutex_ held.
+  bool ReadResponse(const std::string& key, SessionArchiveEntry* entry,
+                    std::vector<uint8_t>* body);
+
+  std::string path_;
+  double time_scale_;
+
+  std::mutex mutex_;
+  FILE* file_;
+  bool opened_;
+  // Responses recorded for each key, in an order they were recorded.
+  std::unordered_map<std::string, std::vector<SessionArchiveEntry>> entries_;
+  // A number of responses served for each key so far.
+  std::unordered_map<std::string, size_t> served_;
+};
+
+#endif  // NATIVE_PLAYER_INC_SESSION_ARCHIVE_H_
@@ -0,0 +1,163 @@
+/*!
+ * shaping_transport.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_SHAPING_TRANSPORT_H_
+#define NATIVE_PLAYER_INC_SHAPING_TRANSPORT_H_
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ppapi/c/pp_errors.h"
+
+#include "transport.h"
+
+/// @file
+/// @brief This file defines the <code>ShapingTransport</code> class and
+/// network conditions it emulates.
+
+/// @struct NetworkConditions
+/// Conditions of an emulated network link.
+struct NetworkConditions {
+  NetworkConditions()
+      : bandwidth(0.),
+        round_trip_time(0.),
+        jitter(0.),
+        stall_interval(0),
+        stall_duration(0.),
+        failure_probability(0.) {}
+
+  /// A link capacity in bits per second, shared by all requests. 0 means an
+  /// unlimited capacity.
+  double bandwidth;
+  /// A delay (in seconds) before a first byte of each response.
+  double round_trip_time;
+  /// A maximum random deviation (in seconds) of a round trip time.
+  double jitter;
+  /// A transfer stalls every time this many bytes of a response are
+  /// delivered. 0 disables stalls.
+  uint64_t stall_interval;
+  /// A duration of a stall in seconds.
+  double stall_duration;
+  /// A probability that a response fails at a random byte.
+  double failure_probability;
+};
+
+/// @struct BandwidthTracePoint
+/// A link capacity in effect from a given time of a bandwidth trace.
+struct BandwidthTracePoint {
+  /// Seconds from a start of a trace.
+  double time;
+  /// A link capacity in bits per second.
+  double bandwidth;
+};
+
+/// @class ShapingTransport
+/// This class emulates network conditions on top of another transport, e.g.
+/// to reproduce buffering and recovery behaviour of a player with a local
+/// HTTP server or <code>FileTransport</code>.
+///
+/// A response body received by a wrapped transport is delivered at a pace
+/// of a link capacity, which is constant or follows a bandwidth trace, after
+/// a round trip time with jitter. A transfer may stall periodically and
+/// fail at a chosen or random byte of a response, as if a connection broke.
+/// Random values come from a generator with a fixed seed, so a run is
+/// repeatable.
+///
+/// All methods of this class are thread safe.
+class ShapingTransport : public Transport {
+ public:
+  /// @param[in] transport A transport which carries out requests.
+  /// @param[in] conditions Initial conditions of a link.
+  explicit ShapingTransport(
+      std::shared_ptr<Transport> transport,
+      const NetworkConditions& conditions = NetworkConditions());
+
+  /// Gets conditions of a predefined profile: <code>"2g"</code>,
+  /// <code>"3g"</code>, <code>"lte"</code>, <code>"dsl"</code>,
+  /// <code>"cable"</code> or <code>"lossy-wifi"</code>.
+  ///
+  /// @return <code>false</code> if a profile is unknown.
+  static bool ConditionsForProfile(const std::string& profile,
+                                   NetworkConditions* conditions);
+
+  /// Parses a bandwidth trace, given as <code>seconds:kbps</code> pairs
+  /// separated by commas or whitespace, e.g.
+  /// <code>"0:4000, 10:800, 25:4000"</code>.
+  ///
+  /// @return <code>false</code> if a trace is malformed.
+  static bool ParseBandwidthTrace(const std::string& text,
+                                  std::vector<BandwidthTracePoint>* trace);
+
+  void SetConditions(const NetworkConditions& conditions);
+
+  /// Makes a link capacity follow a trace. Time of a trace counts from this
+  /// call and a last capacity of a trace stays in effect after it ends. An
+  /// empty trace restores a capacity of current conditions.
+  void SetBandwidthTrace(std::vector<BandwidthTracePoint> trace);
+
+  /// Fails a next response to a URL containing <code>url_part</code> (any
+  /// URL if it's empty) after <code>offset</code> bytes of it are delivered.
+  /// Failures are injected in an order they were added.
+  void InjectFailure(const std::string& url_part, uint64_t offset,
+                     int32_t error = PP_ERROR_FAILED);
+
+  /// Seeds a generator of jitter and random failures.
+  void SetRandomSeed(uint32_t seed);
+
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+
+  bool AcceptsCompressedResponses() const override {
+    return transport_->AcceptsCompressedResponses();
+  }
+
+ private:
+  struct InjectedFailure {
+    std::string url_part;
+    uint64_t offset;
+    int32_t error;
+  };
+
+  // Picks a failure of a response to a given URL, if any. Must be called
+  // with mutex_ held.
+  bool TakeFailure(const std::string& url, InjectedFailure* failure);
+
+  // Returns a link capacity at a given time. Must be called with mutex_
+  // held.
+  double BandwidthAt(std::chrono::steady_clock::time_point time) const;
+
+  // Reserves a link for a given number of bytes and returns a time a last of
+  // them is delivered.
+  std::chrono::steady_clock::time_point ReserveLink(size_t bytes);
+
+  std::shared_ptr<Transport> transport_;
+
+  std::mutex mutex_;
+  NetworkConditions conditions_;
+  std::vector<BandwidthTracePoint> trace_;
+  std::chrono::steady_clock::time_point trace_start_;
+  std::vector<InjectedFailure> failures_;
+  std::mt19937 random_;
+  // A time the link finishes delivering data of all requests so far.
+  std::chrono::steady_clock::time_point link_free_;
+};
+
+#endif  // NATIVE_PLAYER_INC_SHAPING_TRANSPORT_H_
@@ -0,0 +1,60 @@
+/*!
+ * socket_transport.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_SOCKET_TRANSPORT_H_
+#define NATIVE_PLAYER_INC_SOCKET_TRANSPORT_H_
+
+#include <chrono>
+#include <string>
+
+#include "transport.h"
+
+/// @file
+/// @brief This file defines the <code>SocketTransport</code> class.
+
+/// @class SocketTransport
+/// This class carries out plain <code>http://</code> requests over sockets,
+/// without a browser or libcurl, e.g. against a stand-in server on a
+/// localhost. HTTPS isn't supported.
+///
+/// Each request opens its own HTTP/1.0 connection, so responses are never
+/// chunked and a response body ends with a connection. Compressed responses
+/// are passed on as they are received. Redirects are followed up to a few
+/// times.
+class SocketTransport : public Transport {
+ public:
+  /// @param[in] timeout_ms A time allowed for a connection and for each read
+  ///   of a response.
+  explicit SocketTransport(int32_t timeout_ms = 10000);
+
+  int32_t Fetch(const HttpRequest& request, const DownloadDataCallback& on_data,
+                HttpResponseInfo* response) override;
+
+  bool AcceptsCompressedResponses() const override { return true; }
+
+ private:
+  // Carries out a single request. If a response is a redirect, a URL it
+  // points to is returned in location and no data is passed on.
+  int32_t FetchOnce(const HttpRequest& request,
+                    const DownloadDataCallback& on_data,
+                    std::chrono::steady_clock::time_point start,
+                    HttpResponseInfo* response, std::string* location);
+
+  int32_t timeout_ms_;
+};
+
+#endif  // NATIVE_PLAYER_INC_SOCKET_TRANSPORT_H_
@@ -0,0 +1,110 @@
+/*!
+ * transport.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_INC_TRANSPORT_H_
+#define NATIVE_PLAYER_INC_TRANSPORT_H_
+
+#include <memory>
+#include <string>
+
+#include "common.h"
+
+/// @file
+/// @brief This file defines the <code>Transport</code> interface and
+/// functions which select a transport used by all requests.
+
+/// @class Transport
+/// This class is an interface of a backend which carries out HTTP requests
+/// made by a player, i.e. MPD, segment index, segment and license requests.
+///
+/// A request is made by a blocking call from a side thread. A response body
+/// is passed to a callback as it's received and a request is cancelled as
+/// soon as the callback returns <code>false</code>. Byte ranges are requested
+/// with a <code>Range</code> header of a request.
+///
+/// Implementations must be thread safe.
+class Transport {
+ public:
+  virtual ~Transport() {}
+
+  /// Carries out a request, passing a response body to a callback as it's
+  /// received.
+  ///
+  /// @param[in] request A request to carry out.
+  /// @param[in] on_data A callback called with each piece of received data.
+  ///   A request is aborted if it returns <code>false</code>.
+  /// @param[out] response A status code and timing of a transfer. A status
+  ///   code is set before any data is passed to a callback.
+  ///
+  /// @return <code>PP_OK</code> on success, <code>PP_ERROR_ABORTED</code> if
+  ///   a callback aborted a request or another error code on failure.
+  virtual int32_t Fetch(const HttpRequest& request,
+                        const DownloadDataCallback& on_data,
+                        HttpResponseInfo* response) = 0;
+
+  /// Checks if a request may ask for a compressed response with an
+  /// <code>Accept-Encoding</code> header, i.e. a transport passes on a
+  /// response body as it was sent.
+  virtual bool AcceptsCompressedResponses() const { return false; }
+};
+
+/// @enum TransportType
+/// Built-in transports which can be selected with
+/// <code>SetTransportType()</code>.
+enum class TransportType : int32_t {
+  /// <code>pp::URLLoader</code> of a browser (see
+  /// <code>PepperTransport</code>).
+  kPepper = 0,
+  /// libcurl with a pool of persistent connections (see
+  /// <code>CurlTransport</code>).
+  kCurl = 1,
+  /// Plain HTTP over sockets (see <code>SocketTransport</code>).
+  kSocket = 2,
+};
+
+/// Selects a transport used by all subsequent requests. PPAPI
+/// <code>URLLoader</code> is used by default.
+void SetTransport(std::shared_ptr<Transport> transport);
+
+/// Selects one of built-in transports.
+void SetTransportType(TransportType type);
+
+/// Returns a transport used by requests.
+std::shared_ptr<Transport> GetTransport();
+
+/// Parses a <code>Range</code> header of a request for a resource of a given
+/// size. It's meant for transports which serve resources themselves.
+///
+/// @param[in] headers Request headers, one per line.
+/// @param[in] size A size of a requested resource.
+/// @param[out] first A first byte of a requested range.
+/// @param[out] last A last byte of a requested range.
+///
+/// @return <code>true</code> if a request asks for a satisfiable range,
+///   <code>false</code> if it asks for a whole resource. <code>first</code>
+///   and <code>last</code> are set in both cases.
+bool ParseRangeHeader(const std::string& headers, uint64_t size,
+                      uint64_t* first, uint64_t* last);
+
+/// Passes a resource held in memory to a callback as a response to a
+/// request, honouring its <code>Range</code> header. It's meant for
+/// transports which serve resources themselves.
+int32_t ServeResource(const HttpRequest& request, const uint8_t* data,
+                      uint64_t size, const DownloadDataCallback& on_data,
+                      HttpResponseInfo* response);
+
+#endif  // NATIVE_PLAYER_INC_TRANSPORT_H_
@@ -197,6 +197,9 @@ var kSubsOff = 'Subs OFF';
 var kUrlButtonControls = 7;
 var kSendSeekTimeout = 2000;
 var kMilisecondsInSecond = 1000;
+// The first entry of the video menu lets the player choose a representation.
+var kAutoRepresentation = -1;
+var kAutoText = 'Auto';
 
 var clip_duration;
 var current_time;
@@ -209,6 +212,7 @@ var subtitle_timeout;
 var playing = false;
 var show_subtitles = true;
 var ui_enabled = false;
+var video_auto = true;
 
 var selected_clip = kInit;
 var selected_subs = kInit;
@@ -309,18 +313,34 @@ function handleNaclMessage(message_event) {
   case MessageFromPlayerEnum.kVideoRepresentation:
     document.getElementById('video_reps').style.display = 'inline-block';
     var select = document.getElementById('video_select');
+    if (select.length == 0) {
+      var auto_option = document.createElement('option');
+      auto_option.text = kAutoText;
+      select.add(auto_option);
+      video_auto = true;
+    }
     var option = document.createElement('option');
     option.text = message_event.data.bitrate + ' ' +
         message_event.data.width + 'x' + message_event.data.height;
-    select.add(option, select[message_event.data.id]);
+    // Representations follow the "Auto" entry.
+    select.add(option, select[message_event.data.id + 1]);
     break;
   case MessageFromPlayerEnum.kRepresentationChanged:
     var select;
-    if (message_event.data.type == StreamTypeEnum.kAudio)
+    if (message_event.data.type == StreamTypeEnum.kAudio) {
       select = document.getElementById('audio_select');
-    else if (message_event.data.type == StreamTypeEnum.kVideo)
+      select.selectedIndex = message_event.data.id;
+    } else if (message_event.data.type == StreamTypeEnum.kVideo) {
       select = document.getElementById('video_select');
-    select.selectedIndex = message_event.data.id;
+      var current = select[message_event.data.id + 1];
+      if (video_auto) {
+        // Automatic selection stays selected, it shows a current choice.
+        select[0].text = kAutoText + (current ? ' (' + current.text + ')' : '');
+        select.selectedIndex = 0;
+      } else {
+        select.selectedIndex = message_event.data.id + 1;
+      }
+    }
     break;
   case MessageFromPlayerEnum.kSubtitles:
     showSubtitles(message_event.data);
@@ -343,6 +363,27 @@ function handleNaclMessage(message_event) {
   }
 }
 
+// Returns a resolution of a TV panel, or null if it isn't known. A web view
+// (and so the screen object) is usually 1920 x 1080 even on a UHD panel.
+function getPanelResolution() {
+  try {
+    if (typeof webapis != 'undefined' && webapis.productinfo &&
+        webapis.productinfo.isUdPanelSupported())
+      return {width: 3840, height: 2160};
+    if (typeof tizen != 'undefined') {
+      return {
+        width: tizen.systeminfo.getCapability(
+            'http://tizen.org/feature/screen.width'),
+        height: tizen.systeminfo.getCapability(
+            'http://tizen.org/feature/screen.height')
+      };
+    }
+  } catch (e) {
+    console.log('Panel resolution unavailable: ' + e.message);
+  }
+  return null;
+}
+
 function getSeekS(e) {
   var element = e.currentTarget;
   var parent_x = e.pageX -  e.offsetX;
@@ -423,6 +464,51 @@ function onLoadClick() {
         clips[selected_clip].drm_key_request_properties;
   }
 
+  if (clips[selected_clip].hasOwnProperty('start_time'))
+    message.time = parseFloat(clips[selected_clip].start_time);   // float
+
+  if (clips[selected_clip].hasOwnProperty('device_class'))
+    message.device_class = parseInt(clips[selected_clip].device_class);
+
+  if (clips[selected_clip].hasOwnProperty('abr_policy'))
+    message.abr_policy = parseInt(clips[selected_clip].abr_policy);
+
+  // Network settings, defaults are restored when a clip doesn't set them.
+  if (clips[selected_clip].hasOwnProperty('transport'))
+    message.transport = clips[selected_clip].transport;
+
+  if (clips[selected_clip].hasOwnProperty('segment_cache'))
+    message.segment_cache = parseInt(clips[selected_clip].segment_cache);
+
+  if (clips[selected_clip].hasOwnProperty('parallel_connections')) {
+    message.parallel_connections =
+        parseInt(clips[selected_clip].parallel_connections);
+  }
+
+  if (clips[selected_clip].hasOwnProperty('network_profile'))
+    message.network_profile = clips[selected_clip].network_profile;
+
+  if (clips[selected_clip].hasOwnProperty('network_trace'))
+    message.network_trace = clips[selected_clip].network_trace;
+
+  if (clips[selected_clip].hasOwnProperty('record_session'))
+    message.record_session = clips[selected_clip].record_session;
+
+  if (clips[selected_clip].hasOwnProperty('replay_session'))
+    message.replay_session = clips[selected_clip].replay_session;
+
+  if (clips[selected_clip].hasOwnProperty('replay_time_scale')) {
+    message.replay_time_scale =
+        parseFloat(clips[selected_clip].replay_time_scale);   // float
+  }
+
+  // The player assumes no display limit unless a panel resolution is known.
+  var panel = getPanelResolution();
+  if (panel) {
+    message.display_width = panel.width;
+    message.display_height = panel.height;
+  }
+
   nacl_module.postMessage(message);
 }
 
@@ -512,7 +598,7 @@ function sendChangeRepresentation(type, id) {
   nacl_module.postMessage({'messageToPlayer':
                                MessageToPlayerEnum.kChangeRepresentation,
                            'type': type,   // StreamTypeEnum
-                           'id': id});     // integer
+                           'id': id});     // integer, -1 selects automatically
 }
 
 function sendChangeSubtitles(id) {
@@ -557,6 +643,11 @@ function sendRepChange(action) {
   document.getElementById(rep_select).size = 0;
   document.getElementById(rep_select).blur();
   var index = document.getElementById(rep_select).selectedIndex;
+  if (type == StreamTypeEnum.kVideo) {
+    // The first entry is "Auto", representations follow it.
+    index = index - 1;
+    video_auto = (index == kAutoRepresentation);
+  }
   if (type != null)
     sendChangeRepresentation(type, index);
   else
@@ -17,98 +17,77 @@
  * @author Adam Bujalski
  */
 
+#include <errno.h>
+#include <sys/mount.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstdlib>
+#include <mutex>
 
 #include "ppapi/c/pp_errors.h"
-#include "ppapi/cpp/completion_callback.h"
-#include "ppapi/cpp/instance_handle.h"
 #include "ppapi/cpp/message_loop.h"
-#include "ppapi/cpp/module.h"
-#include "ppapi/cpp/url_loader.h"
-#include "ppapi/cpp/url_response_info.h"
 
 #include "common.h"
+#include "curl_transport.h"
 #include "logger.h"
+#include "pepper_transport.h"
+#include "socket_transport.h"
+#include "transport.h"
 
 namespace {
 
-constexpr uint32_t kMinBufferSize = 64 * 1024;
-constexpr uint32_t kExtendBufferSize = 256 * 1024;
+std::mutex transport_mutex;
 
-inline pp::InstanceHandle CurrentInstanceHandle() {
-  pp::Module* module = pp::Module::Get();
-  if (!module) return pp::InstanceHandle(static_cast<PP_Instance>(0));
+std::shared_ptr<Transport>& CurrentTransport() {
+  static std::shared_ptr<Transport> transport =
+      std::make_shared<PepperTransport>();
+  return transport;
+}
 
-  if (module->current_instances().empty())
-    return pp::InstanceHandle(static_cast<PP_Instance>(0));
+int32_t StreamURLRequest(const HttpRequest& request,
+                         const DownloadDataCallback& on_data,
+                         HttpResponseInfo* response) {
+  // Requests block a calling thread.
+  auto current_loop = pp::MessageLoop::GetCurrent();
+  if (!current_loop.is_null() &&
+      current_loop == pp::MessageLoop::GetForMainThread())
+    return PP_ERROR_BLOCKS_MAIN_THREAD;
 
-  return pp::InstanceHandle(module->current_instances().begin()->first);
+  HttpResponseInfo local_response;
+  if (!response)
+    response = &local_response;
+  *response = HttpResponseInfo();
+  int32_t ret = GetTransport()->Fetch(request, on_data, response);
+  const auto& timing = response->timing;
+  LOG_DEBUG("%s %s: %d, status: %d, dns: %.3f connect: %.3f ttfb: %.3f "
+            "total: %.3f [s]", request.method.c_str(), request.url.c_str(),
+            ret, response->status_code, timing.name_lookup, timing.connect,
+            timing.first_byte, timing.total);
+  return ret;
 }
 
+// A response is appended to out, which is allocated once if the response
+// tells its length. Reading straight into out would need it to be resized,
+// i.e. zero-filled, ahead of data.
 template<typename T>
-int32_t ProcessURLRequest(const pp::URLRequestInfo& request, T* out) {
+int32_t ProcessURLRequest(const HttpRequest& request, T* out,
+    const DownloadProgressCallback& progress = DownloadProgressCallback()) {
   if (out == nullptr)
     return PP_ERROR_BADARGUMENT;
 
   out->clear();
-  if (pp::MessageLoop::GetCurrent().is_null())
-    return PP_ERROR_NO_MESSAGE_LOOP;
-
-  if (pp::MessageLoop::GetCurrent() == pp::MessageLoop::GetForMainThread())
-    return PP_ERROR_BLOCKS_MAIN_THREAD;
-
-  if (request.is_null()) {
-    LOG_ERROR("request is null!");
-    return PP_ERROR_BADARGUMENT;
-  }
-
-  pp::URLLoader loader(CurrentInstanceHandle());
-  int32_t ret = loader.Open(request, pp::CompletionCallback());
-  if (ret != PP_OK) {
-    LOG_ERROR("Failed to open URLLoader with given request, code: %d", ret);
-    return ret;
-  }
-
-  pp::URLResponseInfo response_info(loader.GetResponseInfo());
-  if (response_info.is_null()) {
-    LOG_ERROR("URLLoader::GetResponseInfo returned null");
-    return PP_ERROR_FAILED;
-  }
-
-  int32_t status_code = response_info.GetStatusCode();
-  if (status_code >= 400) {
-    LOG_ERROR("Unexpected HTTP status code: %d", status_code);
-    return PP_ERROR_FAILED;
-  }
-
-  size_t bytes_received = 0;
-  while (true) {
-    if (out->size() < bytes_received + kMinBufferSize)
-      out->resize(bytes_received + kExtendBufferSize);
-
-    if (out->size() <= bytes_received) {
-      out->clear();
-      LOG_ERROR("Failed to resize buffer");
-      return PP_ERROR_NOMEMORY;
-    }
-
-    size_t bytes_to_read = out->size() - bytes_received;
-    ret = loader.ReadResponseBody(&(*out)[bytes_received],
-                                  bytes_to_read,
-                                  pp::CompletionCallback());
-    if (ret < 0) {
-      out->clear();
-      LOG_ERROR("Failed to ReadResponseBody, result: %d", ret);
-      return PP_ERROR_FAILED;
-    }
-
-    if (ret == PP_OK) break;
-
-    bytes_received += ret;
-  }
-
-  out->resize(bytes_received);
-  return PP_OK;
+  int32_t ret = StreamURLRequest(request,
+      [out, &progress](const uint8_t* data, size_t size, int64_t total_bytes) {
+        if (out->empty() && total_bytes > 0)
+          out->reserve(total_bytes);
+        out->insert(out->end(), data, data + size);
+        return !progress || progress(out->size(), total_bytes);
+      }, nullptr);
+  if (ret != PP_OK)
+    out->clear();
+  return ret;
 }
 
 }  // namespace
@@ -166,19 +145,111 @@ std::vector<uint8_t> Base64Decode(const std::string& text) {
   return ret;
 }
 
-pp::URLRequestInfo GetRequestForURL(const std::string& url) {
-  pp::URLRequestInfo request(CurrentInstanceHandle());
-  request.SetURL(url);
-  return request;
+bool MountPersistentStorage() {
+  // A quota large enough for cached segments (see SegmentCache).
+  static const char kMountOptions[] =
+      "type=PERSISTENT,expected_size=1073741824";
+  static std::mutex mount_mutex;
+  static bool mounted = false;
+  std::lock_guard<std::mutex> lock(mount_mutex);
+  if (mounted)
+    return true;
+  if (mount("", kPersistentStoragePath, "html5fs", 0, kMountOptions) != 0 &&
+      errno != EBUSY) {
+    LOG_ERROR("Failed to mount a persistent storage at %s, errno: %d",
+              kPersistentStoragePath, errno);
+    return false;
+  }
+  mounted = true;
+  return true;
+}
+
+void SetTransport(std::shared_ptr<Transport> transport) {
+  std::lock_guard<std::mutex> lock(transport_mutex);
+  CurrentTransport() = std::move(transport);
+}
+
+void SetTransportType(TransportType type) {
+  switch (type) {
+    case TransportType::kCurl:
+      LOG_INFO("Using libcurl transport.");
+      // CurlTransport is a singleton, it's never deleted.
+      SetTransport(std::shared_ptr<Transport>(&CurlTransport::GetInstance(),
+                                              [](Transport*) {}));
+      break;
+    case TransportType::kSocket:
+      LOG_INFO("Using socket transport.");
+      SetTransport(std::make_shared<SocketTransport>());
+      break;
+    case TransportType::kPepper:
+    default:
+      LOG_INFO("Using URLLoader transport.");
+      SetTransport(std::make_shared<PepperTransport>());
+      break;
+  }
+}
+
+std::shared_ptr<Transport> GetTransport() {
+  std::lock_guard<std::mutex> lock(transport_mutex);
+  return CurrentTransport();
+}
+
+HttpRequest GetRequestForURL(const std::string& url) {
+  return HttpRequest(url);
+}
+
+int64_t ContentLengthFromHeaders(const std::string& headers) {
+  std::istringstream header_lines(headers);
+  std::string line;
+  int64_t range_length = -1;
+  while (std::getline(header_lines, line)) {
+    auto colon = line.find(':');
+    if (colon == std::string::npos)
+      continue;
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name == "content-length")
+      return std::strtoll(line.c_str() + colon + 1, nullptr, 10);
+    // "Content-Range: bytes first-last/total"
+    if (name == "content-range") {
+      auto first = line.find_first_of("0123456789", colon);
+      auto dash = line.find('-', colon);
+      if (first == std::string::npos || dash == std::string::npos ||
+          first > dash)
+        continue;
+      int64_t first_byte = std::strtoll(line.c_str() + first, nullptr, 10);
+      int64_t last_byte = std::strtoll(line.c_str() + dash + 1, nullptr, 10);
+      if (last_byte >= first_byte)
+        range_length = last_byte - first_byte + 1;
+    }
+  }
+  return range_length;
 }
 
-int32_t ProcessURLRequestOnSideThread(const pp::URLRequestInfo& request,
+int32_t ProcessURLRequestOnSideThread(const HttpRequest& request,
                                       std::string* out) {
   return ProcessURLRequest(request, out);
 }
 
-int32_t ProcessURLRequestOnSideThread(const pp::URLRequestInfo& request,
+int32_t ProcessURLRequestOnSideThread(const HttpRequest& request,
                                       std::vector<uint8_t>* out) {
   return ProcessURLRequest(request, out);
 }
 
+int32_t ProcessURLRequestOnSideThread(const HttpRequest& request,
+    std::vector<uint8_t>* out, const DownloadProgressCallback& progress) {
+  return ProcessURLRequest(request, out, progress);
+}
+
+int32_t StreamURLRequestOnSideThread(const HttpRequest& request,
+                                     const DownloadDataCallback& on_data) {
+  return StreamURLRequestOnSideThread(request, on_data, nullptr);
+}
+
+int32_t StreamURLRequestOnSideThread(const HttpRequest& request,
+                                     const DownloadDataCallback& on_data,
+                                     HttpResponseInfo* response) {
+  if (!on_data)
+    return PP_ERROR_BADARGUMENT;
+  return StreamURLRequest(request, on_data, response);
+}
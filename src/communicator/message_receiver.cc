@@ -21,13 +21,20 @@
 #include "communicator/message_receiver.h"
 
 #include <algorithm>
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #include "ppapi/cpp/var_array.h"
 #include "ppapi/cpp/var_dictionary.h"
 
 #include "communicator/messages.h"
+#include "dash/segment_cache.h"
+#include "player/es_dash_player/async_data_provider.h"
+#include "session_archive.h"
+#include "shaping_transport.h"
+#include "transport.h"
 
 using pp::Var;
 using pp::VarArray;
@@ -39,6 +46,32 @@ inline int32_t ClipToRange(int32_t value, int32_t min, int32_t max) {
   return std::max(min, std::min(value, max));
 }
 
+const char kTransportCurl[] = "curl";
+const char kTransportSocket[] = "socket";
+
+// Wraps a selected transport with ShapingTransport, which emulates a given
+// network profile and/or bandwidth trace.
+void EmulateNetwork(const char* profile, const char* trace) {
+  NetworkConditions conditions;
+  if (profile &&
+      !ShapingTransport::ConditionsForProfile(profile, &conditions)) {
+    LOG_ERROR("Unknown network profile: %s", profile);
+    return;
+  }
+  std::vector<BandwidthTracePoint> bandwidth_trace;
+  if (trace &&
+      !ShapingTransport::ParseBandwidthTrace(trace, &bandwidth_trace)) {
+    LOG_ERROR("Malformed network trace: %s", trace);
+    return;
+  }
+  LOG_INFO("Emulating network profile: %s, trace: %s",
+           profile ? profile : "none", trace ? trace : "none");
+  auto transport =
+      std::make_shared<ShapingTransport>(GetTransport(), conditions);
+  transport->SetBandwidthTrace(std::move(bandwidth_trace));
+  SetTransport(std::move(transport));
+}
+
 }  // anonymous namespace
 
 namespace Communication {
@@ -67,12 +100,25 @@ void MessageReceiver::HandleMessage(pp::InstanceHandle /*instance*/,
       ClosePlayer();
       break;
     case MessageToPlayer::kLoadMedia:
+      ConfigureNetwork(msg.Get(kKeyTransport),
+                       msg.Get(kKeySegmentCache),
+                       msg.Get(kKeyParallelConnections),
+                       msg.Get(kKeyNetworkProfile),
+                       msg.Get(kKeyNetworkTrace),
+                       msg.Get(kKeyRecordSession),
+                       msg.Get(kKeyReplaySession),
+                       msg.Get(kKeyReplayTimeScale));
       LoadMedia(msg.Get(kKeyType),
                 msg.Get(kKeyUrl),
                 msg.Get(kKeySubtitle),
                 msg.Get(kKeyEncoding),
                 msg.Get(kDrmLicenseUrl),
-                msg.Get(kDrmKeyRequestProperties));
+                msg.Get(kDrmKeyRequestProperties),
+                msg.Get(kKeyTime),
+                msg.Get(kKeyDeviceClass),
+                msg.Get(kKeyAbrPolicy),
+                msg.Get(kKeyDisplayWidth),
+                msg.Get(kKeyDisplayHeight));
       break;
     case MessageToPlayer::kPlay:
       Play();
@@ -117,7 +163,12 @@ void MessageReceiver::ClosePlayer() { player_controller_.reset(); }
 void MessageReceiver::LoadMedia(const Var& type, const Var& url,
                                 const Var& subtitle, const Var& encoding,
                                 const Var& license_url,
-                                const Var& key_request_properties) {
+                                const Var& key_request_properties,
+                                const Var& start_time,
+                                const Var& device_class,
+                                const Var& abr_policy,
+                                const Var& display_width,
+                                const Var& display_height) {
   if (!type.is_int() || !url.is_string()) {
     LOG_ERROR("Invalid message - 'url' should be a string");
     return;
@@ -135,6 +186,46 @@ void MessageReceiver::LoadMedia(const Var& type, const Var& url,
       return;
   }
 
+  DeviceClass player_device_class = DeviceClass::kUnknown;
+  if (device_class.is_int()) {
+    switch (static_cast<DeviceClassEnum>(device_class.AsInt())) {
+      case DeviceClassEnum::kLowEnd:
+        player_device_class = DeviceClass::kLowEnd;
+        break;
+      case DeviceClassEnum::kMidRange:
+        player_device_class = DeviceClass::kMidRange;
+        break;
+      case DeviceClassEnum::kHighEnd:
+        player_device_class = DeviceClass::kHighEnd;
+        break;
+      default:
+        LOG_ERROR("Not known device class %d", device_class.AsInt());
+    }
+  }
+
+  AbrPolicyType abr_policy_type = AbrPolicyType::kThroughput;
+  if (abr_policy.is_int()) {
+    switch (static_cast<AbrPolicyEnum>(abr_policy.AsInt())) {
+      case AbrPolicyEnum::kThroughput:
+        abr_policy_type = AbrPolicyType::kThroughput;
+        break;
+      case AbrPolicyEnum::kBufferBased:
+        abr_policy_type = AbrPolicyType::kBufferBased;
+        break;
+      case AbrPolicyEnum::kModelPredictive:
+        abr_policy_type = AbrPolicyType::kModelPredictive;
+        break;
+      default:
+        LOG_ERROR("Not known ABR policy %d", abr_policy.AsInt());
+    }
+  }
+
+  Samsung::NaClPlayer::Rect display_rect;
+  if (display_width.is_int() && display_height.is_int()) {
+    display_rect = Samsung::NaClPlayer::Rect(0, 0, display_width.AsInt(),
+                                             display_height.AsInt());
+  }
+
   std::unordered_map<std::string, std::string> key_request_map;
   if (key_request_properties.is_dictionary()) {
     VarDictionary dict{key_request_properties};
@@ -154,7 +245,63 @@ void MessageReceiver::LoadMedia(const Var& type, const Var& url,
       subtitle.is_string() ? subtitle.AsString() : "",
       encoding.is_string() ? encoding.AsString() : "",
       license_url.is_string() ? license_url.AsString() : "",
-      key_request_map);
+      key_request_map,
+      start_time.is_number() ? start_time.AsDouble() : 0.,
+      player_device_class, abr_policy_type, display_rect);
+}
+
+void MessageReceiver::ConfigureNetwork(const Var& transport,
+                                       const Var& segment_cache,
+                                       const Var& parallel_connections,
+                                       const Var& network_profile,
+                                       const Var& network_trace,
+                                       const Var& record_session,
+                                       const Var& replay_session,
+                                       const Var& replay_time_scale) {
+  ClosePlayer();
+
+  // libcurl sockets go through nacl_io, see NativePlayer::InitNaClIO().
+  std::string transport_name = transport.is_string() ? transport.AsString() :
+                                                       "";
+  if (transport_name == kTransportCurl)
+    SetTransportType(TransportType::kCurl);
+  else if (transport_name == kTransportSocket)
+    SetTransportType(TransportType::kSocket);
+  else
+    SetTransportType(TransportType::kPepper);
+
+  // Segments read from a persistent cache don't reach a transport, so they
+  // would be missing from a recorded session.
+  constexpr uint64_t kMegabyte = 1024 * 1024;
+  uint64_t cache_budget = segment_cache.is_int() ?
+      std::max(segment_cache.AsInt(), 0) * kMegabyte : 0;
+  if (cache_budget && record_session.is_string()) {
+    LOG_INFO("A segment cache is disabled while a session is recorded.");
+    cache_budget = 0;
+  }
+  SegmentCache::GetInstance().SetBudget(cache_budget);
+  AsyncDataProvider::SetParallelConnections(parallel_connections.is_int() ?
+      std::max(parallel_connections.AsInt(), 1) : 1);
+
+  // A replayed session takes place of a network, a recording captures what
+  // a selected transport receives.
+  if (replay_session.is_string()) {
+    SetTransport(std::make_shared<ReplayTransport>(replay_session.AsString(),
+        replay_time_scale.is_number() ? replay_time_scale.AsDouble() : 1.));
+  }
+  if (record_session.is_string()) {
+    SetTransport(std::make_shared<RecordingTransport>(
+        GetTransport(), record_session.AsString()));
+  }
+  // Network emulation wraps whichever transport was selected.
+  std::string profile = network_profile.is_string() ?
+      network_profile.AsString() : "";
+  std::string trace = network_trace.is_string() ? network_trace.AsString() :
+                                                  "";
+  if (!profile.empty() || !trace.empty()) {
+    EmulateNetwork(profile.empty() ? nullptr : profile.c_str(),
+                   trace.empty() ? nullptr : trace.c_str());
+  }
 }
 
 void MessageReceiver::Play() {
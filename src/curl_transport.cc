@@ -0,0 +1,273 @@
+/*!
+ * curl_transport.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "curl_transport.h"
+
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "ppapi/c/pp_errors.h"
+
+namespace {
+
+// How long a driver waits for network activity before it checks for new
+// transfers.
+constexpr int kPollTimeoutMs = 20;
+
+curl_slist* ToHeaderList(const std::string& headers) {
+  curl_slist* list = nullptr;
+  std::istringstream lines(headers);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (!line.empty())
+      list = curl_slist_append(list, line.c_str());
+  }
+  return list;
+}
+
+}  // anonymous namespace
+
+struct CurlTransport::Transfer {
+  Transfer(const DownloadDataCallback& data_callback,
+           HttpResponseInfo* response_info)
+      : easy(nullptr),
+        headers(nullptr),
+        on_data(data_callback),
+        response(response_info),
+        content_length(-1),
+        headers_complete(false),
+        aborted(false),
+        done(false),
+        result(CURLE_OK) {}
+
+  CURL* easy;
+  curl_slist* headers;
+  const DownloadDataCallback& on_data;
+  HttpResponseInfo* response;
+  // Headers of a current response, a response of a redirect is discarded.
+  std::string response_headers;
+  int64_t content_length;
+  bool headers_complete;
+  bool aborted;
+  // Set by a driver under mutex_ once a transfer is removed from a multi
+  // handle.
+  bool done;
+  CURLcode result;
+};
+
+CurlTransport& CurlTransport::GetInstance() {
+  static CurlTransport transport;
+  return transport;
+}
+
+CurlTransport::CurlTransport()
+    : multi_handle_(nullptr),
+      multi_config_pending_(true),
+      driving_(false) {
+  curl_global_init(CURL_GLOBAL_ALL);
+  multi_handle_ = curl_multi_init();
+  if (!multi_handle_)
+    LOG_ERROR("Failed to initialize libcurl.");
+}
+
+CurlTransport::~CurlTransport() {
+  if (multi_handle_)
+    curl_multi_cleanup(static_cast<CURLM*>(multi_handle_));
+  curl_global_cleanup();
+}
+
+void CurlTransport::SetConfig(const Config& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_ = config;
+  // A multi handle can be used by a driver now, so it's configured by one.
+  multi_config_pending_ = true;
+}
+
+int32_t CurlTransport::Fetch(const HttpRequest& request,
+                             const DownloadDataCallback& on_data,
+                             HttpResponseInfo* response) {
+  if (!multi_handle_)
+    return PP_ERROR_FAILED;
+  CURL* easy = curl_easy_init();
+  if (!easy)
+    return PP_ERROR_NOMEMORY;
+
+  Config config;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config = config_;
+  }
+  Transfer transfer(on_data, response);
+  transfer.easy = easy;
+  transfer.headers = ToHeaderList(request.headers);
+
+  curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+  curl_easy_setopt(easy, CURLOPT_PRIVATE, &transfer);
+  curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(easy, CURLOPT_FAILONERROR, 1L);
+  curl_easy_setopt(easy, CURLOPT_TCP_NODELAY, 1L);
+  curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS,
+                   static_cast<long>(config.connect_timeout_ms));
+  curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT,
+                   static_cast<long>(config.low_speed_limit));
+  // libcurl takes whole seconds here.
+  curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME,
+                   static_cast<long>((config.low_speed_time_ms + 999) / 1000));
+  if (!config.ca_bundle_path.empty())
+    curl_easy_setopt(easy, CURLOPT_CAINFO, config.ca_bundle_path.c_str());
+  curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &CurlTransport::OnHeader);
+  curl_easy_setopt(easy, CURLOPT_HEADERDATA, &transfer);
+  curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &CurlTransport::OnData);
+  curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer);
+  if (transfer.headers)
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer.headers);
+  if (request.method == "POST") {
+    curl_easy_setopt(easy, CURLOPT_POST, 1L);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE,
+                     static_cast<long>(request.body.size()));
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body.data());
+  } else if (request.method != "GET") {
+    curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    new_transfers_.push_back(&transfer);
+    while (!transfer.done) {
+      if (driving_) {
+        transfer_done_.wait(lock);
+        continue;
+      }
+      driving_ = true;
+      DriveTransfers(&transfer, &lock);
+      driving_ = false;
+      // Lets one of waiting callers take over driving.
+      transfer_done_.notify_all();
+    }
+  }
+
+  long status_code = 0;
+  curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status_code);
+  response->status_code = status_code;
+  auto& timing = response->timing;
+  curl_easy_getinfo(easy, CURLINFO_NAMELOOKUP_TIME, &timing.name_lookup);
+  curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME, &timing.connect);
+  curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &timing.first_byte);
+  curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME, &timing.total);
+  curl_easy_cleanup(easy);
+  curl_slist_free_all(transfer.headers);
+
+  if (transfer.aborted)
+    return PP_ERROR_ABORTED;
+  switch (transfer.result) {
+    case CURLE_OK:
+      return PP_OK;
+    case CURLE_HTTP_RETURNED_ERROR:
+      LOG_ERROR("Unexpected HTTP status code: %ld", status_code);
+      return PP_ERROR_FAILED;
+    case CURLE_OPERATION_TIMEDOUT:
+      LOG_ERROR("Request timed out: %s", request.url.c_str());
+      return PP_ERROR_TIMEDOUT;
+    default:
+      LOG_ERROR("Request failed: %s, %s", request.url.c_str(),
+                curl_easy_strerror(transfer.result));
+      return PP_ERROR_FAILED;
+  }
+}
+
+void CurlTransport::DriveTransfers(Transfer* own_transfer,
+                                   std::unique_lock<std::mutex>* lock) {
+  CURLM* multi = static_cast<CURLM*>(multi_handle_);
+  std::vector<Transfer*> finished;
+  while (!own_transfer->done) {
+    if (multi_config_pending_) {
+      curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                        static_cast<long>(config_.max_host_connections));
+      curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                        static_cast<long>(config_.max_total_connections));
+      multi_config_pending_ = false;
+    }
+    for (auto transfer : new_transfers_)
+      curl_multi_add_handle(multi, transfer->easy);
+    new_transfers_.clear();
+    lock->unlock();
+
+    // Callbacks of all transfers are called from here.
+    int running = 0;
+    curl_multi_perform(multi, &running);
+    CURLMsg* message;
+    int messages_left;
+    while ((message = curl_multi_info_read(multi, &messages_left))) {
+      if (message->msg != CURLMSG_DONE)
+        continue;
+      CURL* easy = message->easy_handle;
+      char* transfer_ptr = nullptr;
+      curl_easy_getinfo(easy, CURLINFO_PRIVATE, &transfer_ptr);
+      auto transfer = reinterpret_cast<Transfer*>(transfer_ptr);
+      transfer->result = message->data.result;
+      curl_multi_remove_handle(multi, easy);
+      finished.push_back(transfer);
+    }
+    if (finished.empty() && running > 0)
+      curl_multi_wait(multi, nullptr, 0, kPollTimeoutMs, nullptr);
+
+    lock->lock();
+    if (finished.empty())
+      continue;
+    for (auto transfer : finished)
+      transfer->done = true;
+    finished.clear();
+    transfer_done_.notify_all();
+  }
+}
+
+size_t CurlTransport::OnHeader(char* data, size_t size, size_t count,
+                               void* user) {
+  auto transfer = static_cast<Transfer*>(user);
+  size_t length = size * count;
+  // A status line starts each response, e.g. one after a redirect.
+  if (length >= 5 && std::string(data, 5) == "HTTP/")
+    transfer->response_headers.clear();
+  transfer->response_headers.append(data, length);
+  return length;
+}
+
+size_t CurlTransport::OnData(char* data, size_t size, size_t count,
+                             void* user) {
+  auto transfer = static_cast<Transfer*>(user);
+  size_t length = size * count;
+  if (!transfer->headers_complete) {
+    transfer->headers_complete = true;
+    long status_code = 0;
+    curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &status_code);
+    transfer->response->status_code = status_code;
+    transfer->content_length =
+        ContentLengthFromHeaders(transfer->response_headers);
+  }
+  if (!transfer->on_data(reinterpret_cast<const uint8_t*>(data), length,
+                         transfer->content_length)) {
+    transfer->aborted = true;
+    // Anything but length fails a transfer.
+    return 0;
+  }
+  return length;
+}
@@ -22,23 +22,24 @@
 #include <vector>
 #include <string>
 #include <cassert>
+#include <chrono>
 
 #include "ppapi/cpp/completion_callback.h"
 #include "ppapi/cpp/url_loader.h"
 #include "ppapi/cpp/url_response_info.h"
-#include "ppapi/cpp/url_request_info.h"
 
 #include "libdash/libdash.h"
 
 #include "dash/media_stream.h"
 #include "dash/media_segment_sequence.h"
+#include "transport.h"
 
+#include "gzip_inflater.h"
 #include "representation_builder.h"
 
 using pp::CompletionCallback;
 using pp::URLLoader;
 using pp::URLResponseInfo;
-using pp::URLRequestInfo;
 
 // From DASH spec:
 //
@@ -198,13 +199,46 @@ std::unique_ptr<DashManifest> DashManifest::ParseMPD(
   std::unique_ptr<dash::IDASHManager> manager{CreateDashManager()};
   if (!manager) return {};
 
-  URLRequestInfo mpd_request = GetRequestForURL(url);
+  using std::chrono::duration;
+  using std::chrono::steady_clock;
+  auto download_start = steady_clock::now();
+  HttpRequest mpd_request = GetRequestForURL(url);
+  // A browser decompresses responses itself and doesn't let a request set
+  // Accept-Encoding, so a compressed MPD is only asked for if a transport
+  // passes it on.
+  if (GetTransport()->AcceptsCompressedResponses()) {
+    if (!mpd_request.headers.empty())
+      mpd_request.headers += "\n";
+    mpd_request.headers += "Accept-Encoding: gzip";
+  }
   std::string mpd_data;
-  int32_t error_code =  ProcessURLRequestOnSideThread(mpd_request, &mpd_data);
+  size_t received = 0;
+  // A compressed MPD is inflated as it's received, so compressed data isn't
+  // gathered in memory.
+  std::unique_ptr<GzipInflater> inflater;
+  int32_t error_code = StreamURLRequestOnSideThread(mpd_request,
+      [&](const uint8_t* data, size_t size, int64_t) {
+        if (received == 0 && GzipInflater::IsGzip(data, size))
+          inflater = MakeUnique<GzipInflater>();
+        received += size;
+        if (inflater)
+          return inflater->Inflate(data, size, &mpd_data);
+        mpd_data.append(reinterpret_cast<const char*>(data), size);
+        return true;
+      });
+  if (error_code == PP_ERROR_ABORTED) {
+    LOG_ERROR("Failed to decompress MPD");
+    return {};
+  }
   if (error_code != PP_OK) {
     LOG_ERROR("Failed to download MPD: %d", error_code);
     return {};
   }
+  if (inflater && !inflater->IsFinished()) {
+    LOG_ERROR("Compressed MPD is truncated");
+    return {};
+  }
+  auto parse_start = steady_clock::now();
   std::unique_ptr<dash::mpd::IMPD> mpd{manager->Open(url.c_str(),
                                                      mpd_data.data(),
                                                      mpd_data.size())};
@@ -212,6 +246,11 @@ std::unique_ptr<DashManifest> DashManifest::ParseMPD(
     LOG_ERROR("libdash returned null");
     return {};
   }
+  duration<double> download_time = parse_start - download_start;
+  duration<double> parse_time = steady_clock::now() - parse_start;
+  LOG_INFO("MPD downloaded in %.3f [s] (%zu bytes%s, %zu bytes of XML), "
+           "parsed in %.3f [s]", download_time.count(), received,
+           inflater ? " gzip" : "", mpd_data.size(), parse_time.count());
 
   // According to DASH spec must be at least one more Period
   assert(mpd->GetPeriods().size() > 0);
@@ -0,0 +1,76 @@
+/*!
+ * gzip_inflater.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gzip_inflater.h"
+
+#include <cstring>
+
+#include "common.h"
+
+namespace {
+
+// Accepts both gzip and zlib headers.
+constexpr int kWindowBits = 15 + 32;
+constexpr size_t kOutputChunkSize = 64 * 1024;
+
+}  // namespace
+
+GzipInflater::GzipInflater() : initialized_(false), finished_(false) {
+  memset(&stream_, 0, sizeof(stream_));
+  initialized_ = (inflateInit2(&stream_, kWindowBits) == Z_OK);
+  if (!initialized_)
+    LOG_ERROR("Failed to initialize zlib: %s", stream_.msg ? stream_.msg : "");
+}
+
+GzipInflater::~GzipInflater() {
+  if (initialized_)
+    inflateEnd(&stream_);
+}
+
+bool GzipInflater::IsGzip(const uint8_t* data, size_t size) {
+  return size >= 2 && data[0] == 0x1f && data[1] == 0x8b;
+}
+
+bool GzipInflater::Inflate(const uint8_t* data, size_t size,
+                           std::string* out) {
+  if (!initialized_)
+    return false;
+  // Data past an end of a stream (e.g. padding) is ignored.
+  if (finished_)
+    return true;
+  stream_.next_in = const_cast<Bytef*>(data);
+  stream_.avail_in = size;
+  while (stream_.avail_in > 0 && !finished_) {
+    size_t out_size = out->size();
+    out->resize(out_size + kOutputChunkSize);
+    stream_.next_out = reinterpret_cast<Bytef*>(&(*out)[out_size]);
+    stream_.avail_out = kOutputChunkSize;
+    int result = inflate(&stream_, Z_NO_FLUSH);
+    size_t produced = kOutputChunkSize - stream_.avail_out;
+    out->resize(out_size + produced);
+    if (result == Z_STREAM_END) {
+      finished_ = true;
+    } else if (result == Z_BUF_ERROR && produced == 0) {
+      break;
+    } else if (result != Z_OK && result != Z_BUF_ERROR) {
+      LOG_ERROR("Failed to decompress data: %d %s", result,
+                stream_.msg ? stream_.msg : "");
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,52 @@
+/*!
+ * gzip_inflater.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SRC_PLAYER_ES_DASH_PLAYER_DASH_GZIP_INFLATER_H_
+#define SRC_PLAYER_ES_DASH_PLAYER_DASH_GZIP_INFLATER_H_
+
+#include <cstdint>
+#include <string>
+
+#include <zlib.h>
+
+// Decompresses a gzip (or zlib) stream piece by piece as it's received, so
+// compressed data doesn't have to be gathered in memory first.
+class GzipInflater {
+ public:
+  GzipInflater();
+  ~GzipInflater();
+
+  GzipInflater(const GzipInflater&) = delete;
+  GzipInflater& operator=(const GzipInflater&) = delete;
+
+  // Checks if data starts with a gzip header.
+  static bool IsGzip(const uint8_t* data, size_t size);
+
+  // Decompresses a next piece of a stream and appends it to out. Returns false
+  // if a stream is corrupted.
+  bool Inflate(const uint8_t* data, size_t size, std::string* out);
+
+  // Checks if an end of a stream was reached.
+  bool IsFinished() const { return finished_; }
+
+ private:
+  z_stream stream_;
+  bool initialized_;
+  bool finished_;
+};
+
+#endif  // SRC_PLAYER_ES_DASH_PLAYER_DASH_GZIP_INFLATER_H_
@@ -17,13 +17,20 @@
  * @author Adam Bujalski
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <sstream>
 
+#include <unistd.h>
+
 #include "ppapi/c/pp_errors.h"
 
 #include "dash/media_segment_sequence.h"
 
+#include "request_coalescer.h"
 #include "segment_base_sequence.h"
+#include "segment_cache.h"
 #include "segment_list_sequence.h"
 #include "segment_template_sequence.h"
 #include "sequence_iterator.h"
@@ -39,6 +46,10 @@ double MediaSegmentSequence::SegmentTimestamp(const Iterator& it) const {
   return it.SegmentTimestamp(this);
 }
 
+int64_t MediaSegmentSequence::SegmentSize(const Iterator& it) const {
+  return it.SegmentSize(this);
+}
+
 MediaSegmentSequence::Iterator::Iterator() : pimpl_() {}
 
 MediaSegmentSequence::Iterator::Iterator(
@@ -129,10 +140,45 @@ double MediaSegmentSequence::Iterator::SegmentTimestamp(
   return pimpl_->SegmentTimestamp(ptr);
 }
 
+int64_t MediaSegmentSequence::Iterator::SegmentSize(
+    const MediaSegmentSequence* ptr) const {
+  if (!pimpl_)
+    return kUnknownSegmentSize;
+  return pimpl_->SegmentSize(ptr);
+}
 
-bool DownloadSegment(dash::mpd::ISegment* seg, std::vector<uint8_t>* data) {
-  if (!seg || !data) return false;
 
+namespace {
+
+constexpr int32_t kHttpPartialContent = 206;
+constexpr int kMaxDownloadRetries = 4;
+constexpr std::chrono::milliseconds kInitialRetryDelay{250};
+constexpr std::chrono::milliseconds kMaxRetryDelay{4000};
+// How often a download waiting for a retry checks whether it was cancelled.
+constexpr std::chrono::milliseconds kRetryCancelCheckInterval{50};
+
+// Parses a byte range of a chunk ("first-last", last is optional). Returns
+// false if a chunk has no byte range.
+bool GetByteRange(dash::network::IChunk* chunk, uint64_t* first,
+                  int64_t* last) {
+  *first = 0;
+  *last = -1;
+  if (!chunk->HasByteRange())
+    return false;
+  const std::string& range = chunk->Range();
+  auto dash = range.find('-');
+  *first = std::strtoull(range.c_str(), nullptr, 10);
+  if (dash != std::string::npos && dash + 1 < range.size())
+    *last = std::strtoll(range.c_str() + dash + 1, nullptr, 10);
+  return true;
+}
+
+// Creates a request for segment data from a first to a last byte of a
+// resource (-1 for an end of a resource). A Range header is only sent if
+// has_range is set or the first byte isn't a beginning of a resource.
+HttpRequest GetRequestForSegment(dash::mpd::ISegment* seg, bool has_range,
+                                 uint64_t first_byte, int64_t last_byte,
+                                 std::string* url_out) {
   dash::network::IChunk* chunk = static_cast<dash::network::IChunk*>(seg);
   // Quick fix for wrongly parsed MPDs
   // Got url in following form:
@@ -145,22 +191,238 @@ bool DownloadSegment(dash::mpd::ISegment* seg, std::vector<uint8_t>* data) {
   auto last_match = url.rfind("://");
   if (first_match != last_match)
     url.erase(url.begin() + first_match, url.begin() + last_match);
+
+  std::ostringstream range;
+  if (has_range || first_byte > 0) {
+    range << first_byte << "-";
+    if (last_byte >= 0)
+      range << last_byte;
+  }
   LOG_INFO("Downloading segment: %s%s%s", url.c_str(),
-           chunk->HasByteRange() ? " Range: " : "",
-           chunk->HasByteRange() ? chunk->Range().c_str() : "");
+           range.tellp() > 0 ? " Range: " : "", range.str().c_str());
 
   auto request = GetRequestForURL(url);
-  if (chunk->HasByteRange()) {
-    std::ostringstream oss;
-    oss << "Range: bytes=" << chunk->Range();
-    request.SetProperty(PP_URLREQUESTPROPERTY_HEADERS, oss.str());
+  if (range.tellp() > 0)
+    request.headers = "Range: bytes=" + range.str();
+  *url_out = url;
+  return request;
+}
+
+// Downloads a segment, passing its data to on_data as it's received. A
+// transfer which fails halfway is resumed with a Range request from the
+// first byte which wasn't received yet. Retries are delayed with an
+// exponential backoff. While a retry is waited for, on_data is called with
+// no data, so a cancelled download stops without waiting out the delay.
+//
+// Only a part of a segment is downloaded if part_offset or part_size is
+// given. range_ignored is set before data is passed on if a server ignored
+// a Range header.
+int32_t FetchSegment(dash::mpd::ISegment* seg,
+                     const DownloadDataCallback& on_data,
+                     std::string* url, uint64_t part_offset = 0,
+                     int64_t part_size = -1, bool* range_ignored = nullptr) {
+  uint64_t range_first;
+  int64_t range_last;
+  bool has_range = GetByteRange(static_cast<dash::network::IChunk*>(seg),
+                                &range_first, &range_last);
+  if (part_offset > 0 || part_size >= 0) {
+    has_range = true;
+    range_first += part_offset;
+    int64_t part_last = static_cast<int64_t>(range_first) + part_size - 1;
+    if (part_size >= 0 && (range_last < 0 || part_last < range_last))
+      range_last = part_last;
   }
+  int64_t range_size =
+      range_last >= 0 ? range_last - static_cast<int64_t>(range_first) + 1 : -1;
+  uint64_t received = 0;
+  int64_t expected_total = range_size;
+  auto retry_delay = kInitialRetryDelay;
+  for (int retry = 0;; ++retry) {
+    auto request = GetRequestForSegment(seg, has_range,
+                                        range_first + received, range_last,
+                                        url);
+    uint64_t resumed_at = received;
+    // A server which ignores a Range header sends a resource from its start,
+    // so data which was received before has to be skipped.
+    uint64_t skip = 0;
+    bool response_started = false;
+    HttpResponseInfo response;
+    int32_t error_code = StreamURLRequestOnSideThread(request,
+        [&](const uint8_t* data, size_t size, int64_t total_bytes) {
+          if (!response_started) {
+            response_started = true;
+            if ((has_range || resumed_at > 0) &&
+                response.status_code != kHttpPartialContent) {
+              skip = range_first + resumed_at;
+              if (range_ignored)
+                *range_ignored = true;
+            }
+            if (range_size < 0 && total_bytes >= 0)
+              expected_total = resumed_at + total_bytes - skip;
+          }
+          uint64_t skipped = std::min<uint64_t>(skip, size);
+          skip -= skipped;
+          size -= skipped;
+          // Such server also sends data past a requested range.
+          if (expected_total >= 0)
+            size = std::min<uint64_t>(size, expected_total - received);
+          if (size == 0)
+            return true;
+          received += size;
+          return on_data(data + skipped, size, expected_total);
+        }, &response);
+    if (error_code == PP_OK || error_code == PP_ERROR_ABORTED)
+      return error_code;
+    // All data could be received before a connection was dropped.
+    if (expected_total >= 0 &&
+        received == static_cast<uint64_t>(expected_total))
+      return PP_OK;
+    // HTTP errors aren't transient, unlike a dropped connection.
+    if (response.status_code >= 400 || retry == kMaxDownloadRetries)
+      return error_code;
+    LOG_INFO("Segment download failed after %llu bytes, resuming in %lld ms: "
+             "%s", static_cast<unsigned long long>(received),
+             static_cast<long long>(retry_delay.count()), url->c_str());
+    for (auto waited = std::chrono::milliseconds::zero();
+         waited < retry_delay; waited += kRetryCancelCheckInterval) {
+      if (!on_data(nullptr, 0, expected_total))
+        return PP_ERROR_ABORTED;
+      usleep(std::chrono::microseconds(
+          std::min(kRetryCancelCheckInterval, retry_delay - waited)).count());
+    }
+    if (!on_data(nullptr, 0, expected_total))
+      return PP_ERROR_ABORTED;
+    retry_delay = std::min(retry_delay * 2, kMaxRetryDelay);
+  }
+}
+
+std::string CacheKeyForSegment(dash::mpd::ISegment* seg) {
+  dash::network::IChunk* chunk = static_cast<dash::network::IChunk*>(seg);
+  return SegmentCache::KeyFor(chunk->AbsoluteURI(),
+                              chunk->HasByteRange() ? chunk->Range() : "");
+}
+
+}  // namespace
+
+bool DownloadSegment(dash::mpd::ISegment* seg, std::vector<uint8_t>* data) {
+  return DownloadSegment(seg, data, DownloadProgressCallback());
+}
 
-  int32_t error_code = ProcessURLRequestOnSideThread(request, data);
+bool DownloadSegment(dash::mpd::ISegment* seg, std::vector<uint8_t>* data,
+                     const DownloadProgressCallback& progress, bool* cached) {
+  if (!seg || !data) return false;
+
+  if (cached)
+    *cached = false;
+  auto& cache = SegmentCache::GetInstance();
+  std::string key = CacheKeyForSegment(seg);
+  if (cache.IsEnabled() && cache.Get(key, data)) {
+    if (cached)
+      *cached = true;
+    return true;
+  }
+
+  data->clear();
+  // Concurrent requests for the same data (e.g. an initialization segment
+  // shared by representations) are served by a single transfer.
+  int32_t error_code = RequestCoalescer::GetInstance().Download(key, data,
+      progress, [seg](std::vector<uint8_t>* data,
+                      const DownloadProgressCallback& progress) {
+        std::string url;
+        return FetchSegment(seg,
+            [data, &progress](const uint8_t* chunk, size_t size,
+                              int64_t total_bytes) {
+              // Data is appended to a buffer which is allocated once for all
+              // of it if a response tells its length.
+              if (total_bytes > 0 &&
+                  data->capacity() < static_cast<uint64_t>(total_bytes))
+                data->reserve(total_bytes);
+              data->insert(data->end(), chunk, chunk + size);
+              return progress(data->size(), total_bytes);
+            }, &url);
+      });
+  if (error_code != PP_OK)
+    data->clear();
+  if (error_code == PP_ERROR_ABORTED) {
+    LOG_INFO("Segment download aborted: %s", key.c_str());
+    return false;
+  }
+  if (error_code != PP_OK) {
+    LOG_ERROR("Segment download failed: %d", error_code);
+    return false;
+  }
+
+  if (cache.IsEnabled())
+    cache.Put(key, *data);
+  return true;
+}
+
+bool StreamSegment(dash::mpd::ISegment* seg,
+                   const DownloadDataCallback& on_data, bool* cached,
+                   std::vector<uint8_t>* segment_data) {
+  if (!seg || !on_data) return false;
+
+  if (cached)
+    *cached = false;
+  auto& cache = SegmentCache::GetInstance();
+  std::string key = CacheKeyForSegment(seg);
+  // A streamed segment is gathered in a single buffer only if it's going to
+  // be cached: by a caller, by SegmentCache or by both.
+  std::vector<uint8_t> cache_data;
+  if (!segment_data && cache.IsEnabled())
+    segment_data = &cache_data;
+  if (segment_data)
+    segment_data->clear();
+  if (cache.IsEnabled() && cache.Get(key, segment_data)) {
+    if (cached)
+      *cached = true;
+    return on_data(segment_data->data(), segment_data->size(),
+                   segment_data->size());
+  }
+
+  // Concurrent requests for the same segment (e.g. of audio and video stored
+  // in one file) are served by a single transfer. A waiting request still
+  // checks on_data, with no data, so it can be aborted.
+  int32_t error_code = RequestCoalescer::GetInstance().Stream(key,
+      segment_data, on_data,
+      [&on_data](size_t, int64_t total_bytes) {
+        return on_data(nullptr, 0, total_bytes);
+      },
+      [seg](const DownloadDataCallback& pass_data) {
+        std::string url;
+        return FetchSegment(seg, pass_data, &url);
+      });
+  if (error_code == PP_ERROR_ABORTED) {
+    LOG_INFO("Segment download aborted: %s", key.c_str());
+    return false;
+  }
   if (error_code != PP_OK) {
     LOG_ERROR("Segment download failed: %d", error_code);
     return false;
   }
 
+  if (cache.IsEnabled())
+    cache.Put(key, *segment_data);
+  return true;
+}
+
+bool StreamSegmentPart(dash::mpd::ISegment* seg, uint64_t offset, int64_t size,
+                       const DownloadDataCallback& on_data,
+                       bool* range_ignored) {
+  if (!seg || !on_data) return false;
+
+  if (range_ignored)
+    *range_ignored = false;
+  std::string url;
+  int32_t error_code = FetchSegment(seg, on_data, &url, offset, size,
+                                    range_ignored);
+  if (error_code == PP_ERROR_ABORTED) {
+    LOG_DEBUG("Segment part download aborted: %s", url.c_str());
+    return false;
+  }
+  if (error_code != PP_OK) {
+    LOG_ERROR("Segment part download failed: %d", error_code);
+    return false;
+  }
   return true;
 }
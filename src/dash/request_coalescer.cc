@@ -0,0 +1,155 @@
+/*!
+ * request_coalescer.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "request_coalescer.h"
+
+#include <chrono>
+
+namespace {
+
+// How often a waiting request reports progress.
+constexpr std::chrono::milliseconds kProgressInterval{100};
+
+}  // namespace
+
+RequestCoalescer& RequestCoalescer::GetInstance() {
+  static RequestCoalescer coalescer;
+  return coalescer;
+}
+
+int32_t RequestCoalescer::Download(const std::string& key,
+                                   std::vector<uint8_t>* data,
+                                   const DownloadProgressCallback& progress,
+                                   const DownloadFunction& download) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto found = transfers_.find(key); found != transfers_.end();
+       found = transfers_.find(key)) {
+    bool transfer_aborted = false;
+    int32_t result = WaitForTransfer(&lock, found->second, data, progress,
+                                     &transfer_aborted);
+    if (!transfer_aborted)
+      return result;
+    // A download waited for was aborted by its own request, so this request
+    // joins another one or downloads data itself.
+    LOG_INFO("Shared download aborted, retrying: %s", key.c_str());
+  }
+  auto transfer = std::make_shared<Transfer>();
+  transfers_[key] = transfer;
+  lock.unlock();
+  return StartTransfer(key, std::move(transfer), data, progress, download);
+}
+
+int32_t RequestCoalescer::Stream(const std::string& key,
+                                 std::vector<uint8_t>* data,
+                                 const DownloadDataCallback& on_data,
+                                 const DownloadProgressCallback& progress,
+                                 const StreamFunction& stream) {
+  std::vector<uint8_t> shared_data;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto found = transfers_.find(key); found != transfers_.end();
+       found = transfers_.find(key)) {
+    auto* received = data ? data : &shared_data;
+    bool transfer_aborted = false;
+    int32_t result = WaitForTransfer(&lock, found->second, received, progress,
+                                     &transfer_aborted);
+    if (transfer_aborted) {
+      LOG_INFO("Shared download aborted, retrying: %s", key.c_str());
+      continue;
+    }
+    lock.unlock();
+    if (result != PP_OK)
+      return result;
+    return on_data(received->data(), received->size(), received->size()) ?
+        PP_OK : PP_ERROR_ABORTED;
+  }
+  if (!data) {
+    lock.unlock();
+    return stream(on_data);
+  }
+  auto transfer = std::make_shared<Transfer>();
+  transfers_[key] = transfer;
+  lock.unlock();
+  return StartTransfer(key, std::move(transfer), data,
+      DownloadProgressCallback(),
+      [&on_data, &stream](std::vector<uint8_t>* data,
+                          const DownloadProgressCallback& progress) {
+        return stream([data, &on_data, &progress](const uint8_t* chunk,
+            size_t size, int64_t total_bytes) {
+          if (total_bytes > 0 &&
+              data->capacity() < static_cast<uint64_t>(total_bytes))
+            data->reserve(total_bytes);
+          data->insert(data->end(), chunk, chunk + size);
+          return on_data(chunk, size, total_bytes) &&
+                 progress(data->size(), total_bytes);
+        });
+      });
+}
+
+int32_t RequestCoalescer::StartTransfer(
+    const std::string& key, std::shared_ptr<Transfer> transfer,
+    std::vector<uint8_t>* data, const DownloadProgressCallback& progress,
+    const DownloadFunction& download) {
+  int32_t result = download(data,
+      [this, &transfer, &progress](size_t bytes_received,
+                                   int64_t total_bytes) {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          transfer->bytes_received = bytes_received;
+          transfer->total_bytes = total_bytes;
+        }
+        return !progress || progress(bytes_received, total_bytes);
+      });
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  transfers_.erase(key);
+  transfer->done = true;
+  transfer->result = result;
+  if (transfer->waiters > 0) {
+    LOG_DEBUG("Passing a shared download to %d more requests: %s",
+              transfer->waiters, key.c_str());
+    if (result == PP_OK)
+      transfer->data = *data;
+    transfer_done_.notify_all();
+  }
+  return result;
+}
+
+int32_t RequestCoalescer::WaitForTransfer(
+    std::unique_lock<std::mutex>* lock, std::shared_ptr<Transfer> transfer,
+    std::vector<uint8_t>* data, const DownloadProgressCallback& progress,
+    bool* transfer_aborted) {
+  ++transfer->waiters;
+  while (!transfer->done) {
+    transfer_done_.wait_for(*lock, kProgressInterval);
+    if (transfer->done || !progress)
+      continue;
+    size_t bytes_received = transfer->bytes_received;
+    int64_t total_bytes = transfer->total_bytes;
+    lock->unlock();
+    bool proceed = progress(bytes_received, total_bytes);
+    lock->lock();
+    if (!proceed && !transfer->done) {
+      --transfer->waiters;
+      return PP_ERROR_ABORTED;
+    }
+  }
+  --transfer->waiters;
+  if (transfer->result == PP_OK)
+    *data = transfer->data;
+  *transfer_aborted = (transfer->result == PP_ERROR_ABORTED);
+  return transfer->result;
+}
@@ -0,0 +1,121 @@
+/*!
+ * request_coalescer.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SRC_PLAYER_ES_DASH_PLAYER_DASH_REQUEST_COALESCER_H_
+#define SRC_PLAYER_ES_DASH_PLAYER_DASH_REQUEST_COALESCER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ppapi/c/pp_errors.h"
+
+#include "common.h"
+
+// Joins concurrent downloads of the same data (i.e. a URL and a byte range)
+// into a single transfer. This happens e.g. when audio and video are stored
+// in one file, or when representations share an initialization segment.
+//
+// A first request for a key downloads data, requests for the same key made
+// before it finishes wait for its result and get a copy of the data. A waiting
+// request still reports progress, so it can be aborted as usual. If a
+// download which is waited for is aborted, waiting requests download data on
+// their own. A first request may also stream data as it's received, while
+// waiting requests get whole data once it's complete.
+//
+// All methods are thread safe. Downloads are blocking, so they must not be
+// made on the main thread.
+class RequestCoalescer {
+ public:
+  // Downloads data to a given buffer, returns PP_OK or an error code.
+  typedef std::function<int32_t(std::vector<uint8_t>* data,
+                                const DownloadProgressCallback& progress)>
+      DownloadFunction;
+  // Downloads data, passing it to a callback piece by piece. Returns PP_OK or
+  // an error code.
+  typedef std::function<int32_t(const DownloadDataCallback& on_data)>
+      StreamFunction;
+
+  static RequestCoalescer& GetInstance();
+
+  // Downloads data for a given key with a download function, unless the same
+  // key is being downloaded already. Returns PP_OK or an error code.
+  int32_t Download(const std::string& key, std::vector<uint8_t>* data,
+                   const DownloadProgressCallback& progress,
+                   const DownloadFunction& download);
+
+  // Streams data for a given key with a stream function, passing it to
+  // on_data as it's received. If the same key is being downloaded already,
+  // whole data is passed to on_data at once when it's complete, and progress
+  // is reported meanwhile. Data is gathered in data, if given. Other requests
+  // can only wait for a stream which gathers data, so without it a stream
+  // isn't shared. Returns PP_OK or an error code.
+  int32_t Stream(const std::string& key, std::vector<uint8_t>* data,
+                 const DownloadDataCallback& on_data,
+                 const DownloadProgressCallback& progress,
+                 const StreamFunction& stream);
+
+ private:
+  struct Transfer {
+    Transfer()
+        : done(false),
+          result(PP_OK),
+          bytes_received(0),
+          total_bytes(-1),
+          waiters(0) {}
+
+    bool done;
+    int32_t result;
+    size_t bytes_received;
+    int64_t total_bytes;
+    // Requests which wait for this transfer. Data is kept for them once the
+    // transfer is done.
+    int waiters;
+    std::vector<uint8_t> data;
+  };
+
+  RequestCoalescer() {}
+
+  RequestCoalescer(const RequestCoalescer&) = delete;
+  RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+  int32_t StartTransfer(const std::string& key,
+                        std::shared_ptr<Transfer> transfer,
+                        std::vector<uint8_t>* data,
+                        const DownloadProgressCallback& progress,
+                        const DownloadFunction& download);
+
+  // Waits for a result of a transfer started by another request. Must be
+  // called with mutex_ locked. transfer_aborted is set if the transfer was
+  // aborted by a request which started it.
+  int32_t WaitForTransfer(std::unique_lock<std::mutex>* lock,
+                          std::shared_ptr<Transfer> transfer,
+                          std::vector<uint8_t>* data,
+                          const DownloadProgressCallback& progress,
+                          bool* transfer_aborted);
+
+  std::mutex mutex_;
+  std::condition_variable transfer_done_;
+  std::unordered_map<std::string, std::shared_ptr<Transfer>> transfers_;
+};
+
+#endif  // SRC_PLAYER_ES_DASH_PLAYER_DASH_REQUEST_COALESCER_H_
@@ -282,6 +282,13 @@ double SegmentBaseSequence::Timestamp(uint32_t segment) const {
   return segment_index_[segment].timestamp;
 }
 
+int64_t SegmentBaseSequence::Size(uint32_t segment) const {
+  if (segment >= segment_index_.size())
+    return MediaSegmentSequence::kUnknownSegmentSize;
+
+  return static_cast<int64_t>(segment_index_[segment].byte_size);
+}
+
 std::unique_ptr<dash::mpd::ISegment> SegmentBaseSequence::GetBaseSegment()
     const {
   const dash::mpd::IURLType* url = segment_base_->GetInitialization();
@@ -345,6 +352,14 @@ double SegmentBaseIterator::SegmentTimestamp(
   return sequence_->Timestamp(current_index_);
 }
 
+int64_t SegmentBaseIterator::SegmentSize(
+    const MediaSegmentSequence* sequence) const {
+  if (!sequence_ || sequence_ != sequence)
+    return MediaSegmentSequence::kUnknownSegmentSize;
+
+  return sequence_->Size(current_index_);
+}
+
 bool SegmentBaseIterator::operator==(const SegmentBaseIterator& rhs) const {
   return sequence_ == rhs.sequence_ && current_index_ == rhs.current_index_;
 }
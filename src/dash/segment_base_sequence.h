@@ -70,6 +70,7 @@ class SegmentBaseSequence : public MediaSegmentSequence {
   void LoadIndexSegment();
   double Duration(uint32_t segment) const;
   double Timestamp(uint32_t segment) const;
+  int64_t Size(uint32_t segment) const;
   std::unique_ptr<dash::mpd::ISegment> GetBaseSegment() const;
 
   std::vector<dash::mpd::IBaseUrl*> base_urls_;
@@ -94,6 +95,7 @@ class SegmentBaseIterator : public SequenceIterator {
 
   double SegmentDuration(const MediaSegmentSequence*) const override;
   double SegmentTimestamp(const MediaSegmentSequence*) const override;
+  int64_t SegmentSize(const MediaSegmentSequence*) const override;
 
   bool operator==(const SegmentBaseIterator&) const;
 
@@ -0,0 +1,282 @@
+/*!
+ * segment_cache.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "segment_cache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+
+#include "common.h"
+
+namespace {
+
+const char kCacheDir[] = "/persistent/segments";
+const char kIndexFile[] = "index";
+const char kIndexVersion[] = "NPSC1";
+const char kTempSuffix[] = ".tmp";
+
+// A segment larger than this part of a budget isn't cached, so a single
+// segment can't flush the whole cache.
+constexpr uint64_t kMaxEntryBudgetDivisor = 4;
+
+// The index is saved with every stored segment, or once this many cached
+// segments were used since it was saved.
+constexpr uint32_t kMaxUnsavedUses = 16;
+
+std::string CachePath(const std::string& file) {
+  return std::string(kCacheDir) + "/" + file;
+}
+
+// A file name of a segment, a 64-bit FNV-1a hash of its key.
+std::string FileNameForKey(const std::string& key) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return name.str();
+}
+
+// Writes data to a temporary file first and renames it to a given path once
+// it's complete.
+bool WriteFileAtomically(const std::string& path, const std::string& temp_path,
+                         const char* data, size_t size) {
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.write(data, size) || !file.flush()) {
+      LOG_ERROR("Failed to write %s", temp_path.c_str());
+      file.close();
+      unlink(temp_path.c_str());
+      return false;
+    }
+  }
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    LOG_ERROR("Failed to rename %s, errno: %d", temp_path.c_str(), errno);
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+SegmentCache& SegmentCache::GetInstance() {
+  static SegmentCache cache;
+  return cache;
+}
+
+SegmentCache::SegmentCache()
+    : budget_(0),
+      opened_(false),
+      storage_available_(false),
+      total_size_(0),
+      use_counter_(0),
+      unsaved_uses_(0),
+      temp_file_counter_(0) {}
+
+void SegmentCache::SetBudget(uint64_t bytes) {
+  LOG_INFO("Segment cache budget: %llu bytes",
+           static_cast<unsigned long long>(bytes));
+  budget_ = bytes;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (opened_ && storage_available_ && total_size_ > bytes) {
+    Evict(0);
+    SaveIndex();
+  }
+}
+
+std::string SegmentCache::KeyFor(const std::string& url,
+                                 const std::string& range) {
+  return range.empty() ? url : url + " " + range;
+}
+
+bool SegmentCache::Get(const std::string& key, std::vector<uint8_t>* data) {
+  if (!IsEnabled())
+    return false;
+  std::string path;
+  uint64_t size;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!Open())
+      return false;
+    auto found = entries_.find(key);
+    if (found == entries_.end())
+      return false;
+    found->second.last_use = ++use_counter_;
+    if (++unsaved_uses_ >= kMaxUnsavedUses)
+      SaveIndex();
+    path = CachePath(found->second.file);
+    size = found->second.size;
+  }
+
+  // A file is read without a lock, so other segments can be used meanwhile.
+  std::ifstream file(path, std::ios::binary);
+  data->resize(size);
+  if (!file || !file.read(reinterpret_cast<char*>(data->data()), size) ||
+      file.peek() != std::ifstream::traits_type::eof()) {
+    LOG_ERROR("Cached segment %s is damaged, removing it.", path.c_str());
+    data->clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    Remove(key);
+    SaveIndex();
+    return false;
+  }
+  LOG_DEBUG("Segment cache hit: %s", key.c_str());
+  return true;
+}
+
+void SegmentCache::Put(const std::string& key,
+                       const std::vector<uint8_t>& data) {
+  uint64_t budget = budget_;
+  if (!budget || data.empty() || data.size() > budget / kMaxEntryBudgetDivisor)
+    return;
+  std::string file_name = FileNameForKey(key);
+  std::string temp_path;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!Open() || entries_.count(key))
+      return;
+    std::ostringstream temp_name;
+    temp_name << file_name << '.' << ++temp_file_counter_ << kTempSuffix;
+    temp_path = CachePath(temp_name.str());
+  }
+
+  std::string path = CachePath(file_name);
+  if (!WriteFileAtomically(path, temp_path,
+                           reinterpret_cast<const char*>(data.data()),
+                           data.size()))
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Another key with the same hash is replaced by the new file.
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->second.file == file_name) {
+      total_size_ -= it->second.size;
+      entries_.erase(it);
+      break;
+    }
+  }
+  Evict(data.size());
+  entries_[key] = Entry{file_name, data.size(), ++use_counter_};
+  total_size_ += data.size();
+  SaveIndex();
+}
+
+bool SegmentCache::Open() {
+  if (opened_)
+    return storage_available_;
+  opened_ = true;
+  if (!MountPersistentStorage())
+    return false;
+  if (mkdir(kCacheDir, 0755) != 0 && errno != EEXIST) {
+    LOG_ERROR("Failed to create %s, errno: %d", kCacheDir, errno);
+    return false;
+  }
+  storage_available_ = true;
+
+  // Each line of the index holds a file name, a size and a last use of an
+  // entry followed by its key, which may contain spaces.
+  std::ifstream index(CachePath(kIndexFile));
+  std::string line;
+  if (index && std::getline(index, line) && line == kIndexVersion) {
+    while (std::getline(index, line)) {
+      std::istringstream fields(line);
+      Entry entry;
+      std::string key;
+      if (!(fields >> entry.file >> entry.size >> entry.last_use))
+        continue;
+      fields.ignore(1);
+      if (!std::getline(fields, key) || key.empty())
+        continue;
+      struct stat file_stat;
+      if (stat(CachePath(entry.file).c_str(), &file_stat) != 0 ||
+          static_cast<uint64_t>(file_stat.st_size) != entry.size)
+        continue;
+      use_counter_ = std::max(use_counter_, entry.last_use);
+      total_size_ += entry.size;
+      entries_[key] = entry;
+    }
+  }
+
+  // Removes files left by interrupted writes and evictions.
+  std::unordered_set<std::string> files;
+  for (const auto& entry : entries_)
+    files.insert(entry.second.file);
+  if (DIR* dir = opendir(kCacheDir)) {
+    while (dirent* dir_entry = readdir(dir)) {
+      std::string name = dir_entry->d_name;
+      if (name == "." || name == ".." || name == kIndexFile ||
+          files.count(name))
+        continue;
+      unlink(CachePath(name).c_str());
+    }
+    closedir(dir);
+  }
+  LOG_INFO("Segment cache holds %zu segments, %llu bytes.", entries_.size(),
+           static_cast<unsigned long long>(total_size_));
+  if (total_size_ > budget_) {
+    Evict(0);
+    SaveIndex();
+  }
+  return true;
+}
+
+void SegmentCache::Evict(uint64_t bytes_needed) {
+  uint64_t budget = budget_;
+  while (!entries_.empty() && total_size_ + bytes_needed > budget) {
+    auto oldest = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.last_use < oldest->second.last_use)
+        oldest = it;
+    }
+    LOG_DEBUG("Evicting a cached segment: %s", oldest->first.c_str());
+    Remove(oldest->first);
+  }
+}
+
+void SegmentCache::Remove(const std::string& key) {
+  auto found = entries_.find(key);
+  if (found == entries_.end())
+    return;
+  unlink(CachePath(found->second.file).c_str());
+  total_size_ -= found->second.size;
+  entries_.erase(found);
+}
+
+void SegmentCache::SaveIndex() {
+  unsaved_uses_ = 0;
+  std::ostringstream index;
+  index << kIndexVersion << '\n';
+  for (const auto& entry : entries_) {
+    index << entry.second.file << ' ' << entry.second.size << ' '
+          << entry.second.last_use << ' ' << entry.first << '\n';
+  }
+  std::string content = index.str();
+  WriteFileAtomically(CachePath(kIndexFile),
+                      CachePath(std::string(kIndexFile) + kTempSuffix),
+                      content.data(), content.size());
+}
@@ -0,0 +1,100 @@
+/*!
+ * segment_cache.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SRC_PLAYER_ES_DASH_PLAYER_DASH_SEGMENT_CACHE_H_
+#define SRC_PLAYER_ES_DASH_PLAYER_DASH_SEGMENT_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A cache of downloaded segments (media, initialization and index data) in a
+// persistent storage, so replaying a title or seeking back to a position
+// watched recently doesn't need a network.
+//
+// Segments are keyed by a URL and a byte range. Each segment is stored in its
+// own file, along with an index file which lists cached segments with their
+// sizes and a last use. The least recently used segments are evicted when a
+// size budget is exceeded.
+//
+// Files are written to a temporary name and renamed once complete, and the
+// index is replaced the same way, so an interrupted write never leaves a
+// partial segment in the cache. Files which aren't listed in the index are
+// removed when the cache is opened.
+//
+// The cache is disabled until a budget is set. All methods are thread safe,
+// but they access html5fs, so they must not be called on the main thread.
+class SegmentCache {
+ public:
+  static SegmentCache& GetInstance();
+
+  // Sets a size budget in bytes, 0 disables the cache.
+  void SetBudget(uint64_t bytes);
+
+  bool IsEnabled() const { return budget_ > 0; }
+
+  static std::string KeyFor(const std::string& url, const std::string& range);
+
+  // Reads a cached segment. Returns false if it isn't cached.
+  bool Get(const std::string& key, std::vector<uint8_t>* data);
+
+  // Stores a segment, evicting the least recently used segments if needed.
+  void Put(const std::string& key, const std::vector<uint8_t>& data);
+
+ private:
+  struct Entry {
+    std::string file;
+    uint64_t size;
+    uint64_t last_use;
+  };
+
+  SegmentCache();
+
+  SegmentCache(const SegmentCache&) = delete;
+  SegmentCache& operator=(const SegmentCache&) = delete;
+
+  // Mounts a storage and loads the index once. Must be called with mutex_
+  // locked.
+  bool Open();
+
+  // Removes the least recently used entries until a given number of bytes
+  // fits a budget. Must be called with mutex_ locked.
+  void Evict(uint64_t bytes_needed);
+
+  void Remove(const std::string& key);
+
+  // Must be called with mutex_ locked.
+  void SaveIndex();
+
+  std::atomic<uint64_t> budget_;
+  std::mutex mutex_;
+  bool opened_;
+  bool storage_available_;
+  uint64_t total_size_;
+  // Incremented with each use, it orders entries from the least recently
+  // used across sessions.
+  uint64_t use_counter_;
+  // Uses of entries which aren't stored in the index yet.
+  uint32_t unsaved_uses_;
+  uint32_t temp_file_counter_;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+#endif  // SRC_PLAYER_ES_DASH_PLAYER_DASH_SEGMENT_CACHE_H_
@@ -19,6 +19,10 @@
 
 #include "sequence_iterator.h"
 
+int64_t SequenceIterator::SegmentSize(const MediaSegmentSequence*) const {
+  return MediaSegmentSequence::kUnknownSegmentSize;
+}
+
 bool SequenceIterator::EqualsTo(const SegmentBaseIterator&) const {
   return false;
 }
@@ -48,6 +48,10 @@ class SequenceIterator {
   /// returns value < 0 in case of error (like invalid iterator).
   virtual double SegmentTimestamp(const MediaSegmentSequence*) const = 0;
 
+  /// Checks given segment size in bytes
+  /// returns value < 0 if it's not known before a download.
+  virtual int64_t SegmentSize(const MediaSegmentSequence*) const;
+
   // Simple double dispatch for Equals as *Iterator class hierarchy will be
   // changed rarely as it's bounded with DASH spec.
   virtual bool EqualsTo(const SegmentBaseIterator&) const;
@@ -19,6 +19,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -52,6 +53,10 @@ const std::string kDRMInitDataType("cenc:pssh");
 static const int kKidLength = 16;
 static const size_t kErrorBufferSize = 1024;
 static const uint32_t kBufferSize = 128 * 1024;
+// Demuxing is delayed by at most this much when media memory is over budget.
+// The wait is bounded, as packets of this stream may be needed to append
+// packets which hold memory.
+static const std::chrono::milliseconds kMemoryBudgetWait(100);
 static const uint32_t kMicrosecondsPerSecond = 1000000;
 static const TimeTicks kOneMicrosecond = 1.0 / kMicrosecondsPerSecond;
 static const AVRational kMicrosBase = {1, kMicrosecondsPerSecond};
@@ -64,6 +69,73 @@ static const double kSegmentEps = 0.5;
 
 static int s_demux_id = 0;
 
+static const size_t kBoxHeaderSize = 8;
+
+static uint32_t BoxType(const char (&type)[5]) {
+  return (static_cast<uint32_t>(type[0]) << 24) |
+         (static_cast<uint32_t>(type[1]) << 16) |
+         (static_cast<uint32_t>(type[2]) << 8) |
+         static_cast<uint32_t>(type[3]);
+}
+
+static uint64_t ReadBigEndian(const uint8_t* data, size_t bytes) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < bytes; ++i)
+    value = (value << 8) | data[i];
+  return value;
+}
+
+// Looks for an ISO BMFF box of a given type among boxes placed within
+// [begin, end). On success, [*payload_begin, *payload_end) is set to the box
+// payload. Boxes which are not fully present in a given range are ignored.
+static bool FindBox(const uint8_t* begin, const uint8_t* end, uint32_t type,
+                    const uint8_t** payload_begin,
+                    const uint8_t** payload_end) {
+  const uint8_t* box = begin;
+  while (box + kBoxHeaderSize <= end) {
+    uint64_t box_size = ReadBigEndian(box, 4);
+    uint32_t box_type = static_cast<uint32_t>(ReadBigEndian(box + 4, 4));
+    size_t header_size = kBoxHeaderSize;
+    if (box_size == 1) {  // 64-bit largesize follows box type
+      if (box + kBoxHeaderSize + 8 > end) return false;
+      box_size = ReadBigEndian(box + kBoxHeaderSize, 8);
+      header_size += 8;
+    } else if (box_size == 0) {  // box extends to the end of data
+      box_size = end - box;
+    }
+    if (box_size < header_size ||
+        box_size > static_cast<uint64_t>(end - box))
+      return false;
+    if (box_type == type) {
+      *payload_begin = box + header_size;
+      *payload_end = box + box_size;
+      return true;
+    }
+    box += box_size;
+  }
+  return false;
+}
+
+// Checks if data contains a movie fragment ('moof' box) and, if so, whether
+// a track fragment carries a decode time ('tfdt' box, baseMediaDecodeTime).
+static bool FindMovieFragment(const std::vector<uint8_t>& data,
+                              bool* has_decode_time) {
+  const uint8_t* begin = data.data();
+  const uint8_t* end = data.data() + data.size();
+  const uint8_t* moof_begin;
+  const uint8_t* moof_end;
+  if (!FindBox(begin, end, BoxType("moof"), &moof_begin, &moof_end))
+    return false;
+  const uint8_t* traf_begin;
+  const uint8_t* traf_end;
+  const uint8_t* tfdt_begin;
+  const uint8_t* tfdt_end;
+  *has_decode_time =
+      FindBox(moof_begin, moof_end, BoxType("traf"), &traf_begin, &traf_end) &&
+      FindBox(traf_begin, traf_end, BoxType("tfdt"), &tfdt_begin, &tfdt_end);
+  return true;
+}
+
 static TimeTicks ToTimeTicks(int64_t time_ticks, AVRational time_base) {
   int64_t us = av_rescale_q(time_ticks, time_base, kMicrosBase);
   return us * kOneMicrosecond;
@@ -111,6 +183,8 @@ FFMpegDemuxer::FFMpegDemuxer(const pp::InstanceHandle& instance,
       callback_factory_(this),
       format_context_(nullptr),
       io_context_(nullptr),
+      buffer_memory_(MemoryGovernor::kDemuxerInput),
+      io_buffer_memory_(MemoryGovernor::kDemuxerIoBuffer),
       context_opened_(false),
       streams_initialized_(false),
       end_of_file_(false),
@@ -118,6 +192,7 @@ FFMpegDemuxer::FFMpegDemuxer(const pp::InstanceHandle& instance,
       probe_size_(probe_size),
       timestamp_(0.0),
       has_packets_(false),
+      timestamp_source_(kTimestampUnknown),
       init_mode_(init_mode),
       demux_id_(++s_demux_id) {
   LOG_DEBUG("parser: %p", this);
@@ -161,6 +236,7 @@ bool FFMpegDemuxer::Init(const InitCallback& callback,
     return false;
   }
 
+  io_buffer_memory_.Set(kBufferSize);
   io_context_->seekable = 0;
   io_context_->write_flag = 0;
 
@@ -200,7 +276,16 @@ void FFMpegDemuxer::Parse(const std::vector<uint8_t>& data) {
       end_of_file_ = true;
       signal_buffer = true;
     } else {
+      bool has_decode_time;
+      if (timestamp_source_ == kTimestampUnknown &&
+          FindMovieFragment(data, &has_decode_time)) {
+        timestamp_source_ = has_decode_time ? kTimestampFromTfdt :
+                                              kTimestampRebased;
+        LOG_DEBUG("parser: %p, fragment %s a tfdt box", this,
+                  has_decode_time ? "has" : "doesn't have");
+      }
       buffer_.insert(buffer_.end(), data.begin(), data.end());
+      buffer_memory_.Set(buffer_.size());
       signal_buffer = true;
       LOG_DEBUG("parser: %p, Added buffer to parser.", this);
     }
@@ -261,8 +346,13 @@ void FFMpegDemuxer::ParsingThreadFn() {
 
   AVPacket pkt;
   bool finished_parsing = false;
+  auto& memory_governor = MemoryGovernor::GetInstance();
 
   while (!finished_parsing) {
+    if (memory_governor.IsOverBudget() &&
+        !memory_governor.WaitForBudget(kMemoryBudgetWait)) {
+      LOG_DEBUG("parser: %p, media memory is over budget", this);
+    }
     av_init_packet(&pkt);
     pkt.data = NULL;
     pkt.size = 0;
@@ -374,6 +464,7 @@ int FFMpegDemuxer::Read(uint8_t* data, int size) {
     size_t read_bytes = std::min(size, static_cast<int>(buffer_.size()));
     memcpy(data, buffer_.data(), read_bytes);
     buffer_.erase(buffer_.begin(), buffer_.begin() + read_bytes);
+    buffer_memory_.Set(buffer_.size());
     return read_bytes;
   }
 
@@ -642,14 +733,27 @@ unique_ptr<ElementaryStreamPacket> FFMpegDemuxer::MakeESPacketFromAVPacket(
 
   auto pts = ToTimeTicks(pkt->pts, s->time_base);
   auto dts = ToTimeTicks(pkt->dts, s->time_base);
-  if (!has_packets_ && pts + kSegmentEps >= timestamp_) {
-      LOG_DEBUG("Got properly timestamped packet. Zero timestamp variable");
-      timestamp_ = 0;
+  TimeTicks offset = 0;
+  switch (timestamp_source_) {
+    case kTimestampFromTfdt:
+      // ffmpeg takes fragment decode times from tfdt boxes.
+      break;
+    case kTimestampRebased:
+      offset = timestamp_;
+      break;
+    default:
+      // Not a fragmented MP4 content, guess whether timestamps are relative
+      // to the first segment parsed by this demuxer.
+      if (!has_packets_ && pts + kSegmentEps >= timestamp_) {
+        LOG_DEBUG("Got properly timestamped packet. Zero timestamp variable");
+        timestamp_ = 0;
+      }
+      offset = timestamp_;
   }
   has_packets_ = true;
 
-  es_packet->SetPts(pts + timestamp_);
-  es_packet->SetDts(dts + timestamp_);
+  es_packet->SetPts(pts + offset);
+  es_packet->SetDts(dts + offset);
 
   AVEncInfo* enc_info = reinterpret_cast<AVEncInfo*>(
       av_packet_get_side_data(pkt, AV_PKT_DATA_ENCRYPT_INFO, NULL));
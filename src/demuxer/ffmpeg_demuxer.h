@@ -40,6 +40,7 @@ extern "C" {
 }
 
 #include "demuxer/stream_demuxer.h"
+#include "memory_governor.h"
 
 class FFMpegDemuxer : public StreamDemuxer {
  public:
@@ -116,6 +117,8 @@ class FFMpegDemuxer : public StreamDemuxer {
   std::condition_variable buffer_condition_;
   pp::MessageLoop callback_dispatcher_;
   std::vector<uint8_t> buffer_;
+  MemoryAccount buffer_memory_;
+  MemoryAccount io_buffer_memory_;
   // in case of performance issues, buffer_ may be changed to a list of
   // buffers to reduce amount of data copying
   bool context_opened_;
@@ -125,6 +128,19 @@ class FFMpegDemuxer : public StreamDemuxer {
   uint32_t probe_size_;
   Samsung::NaClPlayer::TimeTicks timestamp_;
   bool has_packets_;
+
+  // Describes how packet timestamps are derived from container timestamps.
+  enum TimestampSource {
+    // Not determined yet, falls back to guessing on a first packet.
+    kTimestampUnknown,
+    // Fragments carry 'tfdt' boxes, hence timestamps read by ffmpeg are
+    // already relative to a beginning of a presentation.
+    kTimestampFromTfdt,
+    // Fragments don't carry 'tfdt' boxes, so ffmpeg counts timestamps from
+    // a first parsed fragment. They need to be shifted by timestamp_.
+    kTimestampRebased,
+  };
+  TimestampSource timestamp_source_;
   InitMode init_mode_;
 
   int demux_id_;
@@ -0,0 +1,125 @@
+/*!
+ * file_transport.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "file_transport.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "ppapi/c/pp_errors.h"
+
+namespace {
+
+constexpr int32_t kHttpOk = 200;
+constexpr int32_t kHttpPartialContent = 206;
+constexpr int32_t kHttpNotFound = 404;
+constexpr int32_t kHttpMethodNotAllowed = 405;
+constexpr size_t kReadBufferSize = 64 * 1024;
+
+const char kFileScheme[] = "file://";
+
+struct FileCloser {
+  void operator()(FILE* file) const { fclose(file); }
+};
+
+}  // anonymous namespace
+
+FileTransport::FileTransport(const std::string& root_directory)
+    : root_directory_(root_directory) {
+  // A path of a URL starts with a slash.
+  while (!root_directory_.empty() && root_directory_.back() == '/')
+    root_directory_.pop_back();
+}
+
+std::string FileTransport::PathForURL(const std::string& url) const {
+  std::string path;
+  if (url.compare(0, sizeof(kFileScheme) - 1, kFileScheme) == 0) {
+    path = url.substr(sizeof(kFileScheme) - 1);
+  } else {
+    auto scheme_end = url.find("://");
+    if (root_directory_.empty() || scheme_end == std::string::npos)
+      return std::string();
+    auto path_start = url.find('/', scheme_end + 3);
+    path = root_directory_ +
+        (path_start == std::string::npos ? "/" : url.substr(path_start));
+  }
+  // A query and a fragment don't name a file.
+  path = path.substr(0, path.find_first_of("?#"));
+  // A path must not escape a root directory.
+  if (path.find("/../") != std::string::npos)
+    return std::string();
+  return path;
+}
+
+int32_t FileTransport::Fetch(const HttpRequest& request,
+                             const DownloadDataCallback& on_data,
+                             HttpResponseInfo* response) {
+  using std::chrono::steady_clock;
+  using std::chrono::duration;
+
+  auto start = steady_clock::now();
+  if (request.method != "GET") {
+    LOG_ERROR("Unsupported method %s: %s", request.method.c_str(),
+              request.url.c_str());
+    response->status_code = kHttpMethodNotAllowed;
+    return PP_ERROR_FAILED;
+  }
+  std::string path = PathForURL(request.url);
+  std::unique_ptr<FILE, FileCloser> file(
+      path.empty() ? nullptr : fopen(path.c_str(), "rb"));
+  if (!file) {
+    LOG_ERROR("Can't open %s for %s", path.c_str(), request.url.c_str());
+    response->status_code = kHttpNotFound;
+    return PP_ERROR_FILENOTFOUND;
+  }
+  if (fseek(file.get(), 0, SEEK_END) != 0)
+    return PP_ERROR_FAILED;
+  long size = ftell(file.get());
+  if (size < 0)
+    return PP_ERROR_FAILED;
+
+  uint64_t first;
+  uint64_t last;
+  bool ranged = ParseRangeHeader(request.headers, size, &first, &last);
+  response->status_code = ranged ? kHttpPartialContent : kHttpOk;
+  uint64_t end = size > 0 ? last + 1 : 0;
+  if (fseek(file.get(), first, SEEK_SET) != 0)
+    return PP_ERROR_FAILED;
+  response->timing.first_byte =
+      duration<double>(steady_clock::now() - start).count();
+
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[kReadBufferSize]);
+  int64_t total_bytes = end - first;
+  for (uint64_t offset = first; offset < end;) {
+    size_t read = fread(buffer.get(), 1,
+                        std::min<uint64_t>(kReadBufferSize, end - offset),
+                        file.get());
+    if (read == 0) {
+      LOG_ERROR("Failed to read %s", path.c_str());
+      return PP_ERROR_FAILED;
+    }
+    offset += read;
+    if (!on_data(buffer.get(), read, total_bytes))
+      return PP_ERROR_ABORTED;
+  }
+  response->timing.total =
+      duration<double>(steady_clock::now() - start).count();
+  return PP_OK;
+}
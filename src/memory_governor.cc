@@ -0,0 +1,137 @@
+/*!
+ * memory_governor.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "memory_governor.h"
+
+#include "common.h"
+
+namespace {
+
+constexpr size_t kMegabyte = 1024 * 1024;
+
+constexpr size_t kLowEndBudget = 48 * kMegabyte;
+constexpr size_t kMidRangeBudget = 96 * kMegabyte;
+constexpr size_t kHighEndBudget = 192 * kMegabyte;
+
+constexpr std::chrono::seconds kReportInterval{10};
+
+const char* const kComponentNames[MemoryGovernor::kComponentCount] = {
+  "segments",     // kSegmentData
+  "demux input",  // kDemuxerInput
+  "demux io",     // kDemuxerIoBuffer
+  "packets",      // kPacketQueue
+  "cache",        // kSegmentCache
+  "buffer pool",  // kSegmentBufferPool
+};
+
+double ToMegabytes(size_t bytes) {
+  return static_cast<double>(bytes) / kMegabyte;
+}
+
+}  // anonymous namespace
+
+MemoryGovernor& MemoryGovernor::GetInstance() {
+  static MemoryGovernor governor;
+  return governor;
+}
+
+MemoryGovernor::MemoryGovernor()
+    : total_usage_(0),
+      peak_usage_(0),
+      budget_(kMidRangeBudget),
+      last_report_() {
+  for (auto& usage : usage_)
+    usage = 0;
+}
+
+size_t MemoryGovernor::BudgetForDeviceClass(DeviceClass device_class) {
+  switch (device_class) {
+    case DeviceClass::kLowEnd:
+      return kLowEndBudget;
+    case DeviceClass::kHighEnd:
+      return kHighEndBudget;
+    case DeviceClass::kMidRange:
+    case DeviceClass::kUnknown:
+    default:
+      return kMidRangeBudget;
+  }
+}
+
+void MemoryGovernor::SetDeviceClass(DeviceClass device_class) {
+  SetBudget(BudgetForDeviceClass(device_class));
+}
+
+void MemoryGovernor::SetBudget(size_t bytes) {
+  LOG_INFO("Media memory budget: %.1f MB", ToMegabytes(bytes));
+  budget_ = bytes;
+  peak_usage_ = total_usage_.load();
+  budget_condition_.notify_all();
+}
+
+void MemoryGovernor::Add(Component component, size_t bytes) {
+  usage_[component] += bytes;
+  size_t total = (total_usage_ += bytes);
+  size_t peak = peak_usage_;
+  while (total > peak && !peak_usage_.compare_exchange_weak(peak, total)) {}
+}
+
+void MemoryGovernor::Release(Component component, size_t bytes) {
+  usage_[component] -= bytes;
+  size_t total = (total_usage_ -= bytes);
+  if (total <= budget_ && total + bytes > budget_) {
+    // Usage dropped below the budget, wake up producers. Locking assures a
+    // producer doesn't miss this between checking usage and waiting.
+    { std::lock_guard<std::mutex> lock(budget_mutex_); }
+    budget_condition_.notify_all();
+  }
+}
+
+bool MemoryGovernor::WaitForBudget(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(budget_mutex_);
+  return budget_condition_.wait_for(lock, timeout, [this]() {
+    return !IsOverBudget();
+  });
+}
+
+void MemoryGovernor::ReportUsage() {
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(budget_mutex_);
+    if (now - last_report_ < kReportInterval)
+      return;
+    last_report_ = now;
+  }
+  std::ostringstream report;
+  report.precision(1);
+  report << std::fixed;
+  for (int i = 0; i < kComponentCount; ++i) {
+    report << (i ? ", " : "") << kComponentNames[i] << ": "
+           << ToMegabytes(usage_[i]) << " MB";
+  }
+  LOG_INFO("Media memory %.1f / %.1f MB (peak %.1f MB) - %s",
+           ToMegabytes(total_usage_), ToMegabytes(budget_),
+           ToMegabytes(peak_usage_), report.str().c_str());
+}
+
+void MemoryAccount::Set(size_t bytes) {
+  auto& governor = MemoryGovernor::GetInstance();
+  if (bytes > bytes_)
+    governor.Add(component_, bytes - bytes_);
+  else if (bytes < bytes_)
+    governor.Release(component_, bytes_ - bytes);
+  bytes_ = bytes;
+}
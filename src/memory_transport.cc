@@ -0,0 +1,58 @@
+/*!
+ * memory_transport.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "memory_transport.h"
+
+#include "ppapi/c/pp_errors.h"
+
+namespace {
+
+constexpr int32_t kHttpNotFound = 404;
+
+}  // anonymous namespace
+
+void MemoryTransport::AddResource(const std::string& url,
+                                  std::vector<uint8_t> data) {
+  auto resource =
+      std::make_shared<const std::vector<uint8_t>>(std::move(data));
+  std::lock_guard<std::mutex> lock(mutex_);
+  resources_[url] = std::move(resource);
+}
+
+void MemoryTransport::RemoveResource(const std::string& url) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  resources_.erase(url);
+}
+
+int32_t MemoryTransport::Fetch(const HttpRequest& request,
+                               const DownloadDataCallback& on_data,
+                               HttpResponseInfo* response) {
+  std::shared_ptr<const std::vector<uint8_t>> resource;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = resources_.find(request.url);
+    if (found != resources_.end())
+      resource = found->second;
+  }
+  if (!resource) {
+    LOG_ERROR("No resource for %s", request.url.c_str());
+    response->status_code = kHttpNotFound;
+    return PP_ERROR_FILENOTFOUND;
+  }
+  return ServeResource(request, resource->data(), resource->size(), on_data,
+                       response);
+}
@@ -0,0 +1,134 @@
+/*!
+ * pepper_transport.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "pepper_transport.h"
+
+#include <chrono>
+#include <memory>
+
+#include "ppapi/c/pp_errors.h"
+#include "ppapi/cpp/completion_callback.h"
+#include "ppapi/cpp/instance_handle.h"
+#include "ppapi/cpp/message_loop.h"
+#include "ppapi/cpp/module.h"
+#include "ppapi/cpp/url_loader.h"
+#include "ppapi/cpp/url_request_info.h"
+#include "ppapi/cpp/url_response_info.h"
+#include "ppapi/cpp/var.h"
+
+namespace {
+
+constexpr uint32_t kReadBufferSize = 64 * 1024;
+
+inline pp::InstanceHandle CurrentInstanceHandle() {
+  pp::Module* module = pp::Module::Get();
+  if (!module) return pp::InstanceHandle(static_cast<PP_Instance>(0));
+
+  if (module->current_instances().empty())
+    return pp::InstanceHandle(static_cast<PP_Instance>(0));
+
+  return pp::InstanceHandle(module->current_instances().begin()->first);
+}
+
+pp::URLRequestInfo ToPepperRequest(const HttpRequest& request) {
+  pp::URLRequestInfo pepper_request(CurrentInstanceHandle());
+  pepper_request.SetURL(request.url);
+  pepper_request.SetMethod(request.method);
+  if (!request.headers.empty())
+    pepper_request.SetHeaders(request.headers);
+  if (!request.body.empty())
+    pepper_request.AppendDataToBody(request.body.data(), request.body.size());
+  return pepper_request;
+}
+
+// Opens a given request with a loader and checks a response status. A
+// Content-Length of a response is stored in content_length (-1 if it has
+// none) and a status code in response.
+int32_t OpenURLRequest(const pp::URLRequestInfo& request,
+                       pp::URLLoader* loader, int64_t* content_length,
+                       HttpResponseInfo* response) {
+  if (request.is_null()) {
+    LOG_ERROR("request is null!");
+    return PP_ERROR_BADARGUMENT;
+  }
+
+  int32_t ret = loader->Open(request, pp::CompletionCallback());
+  if (ret != PP_OK) {
+    LOG_ERROR("Failed to open URLLoader with given request, code: %d", ret);
+    return ret;
+  }
+
+  pp::URLResponseInfo response_info(loader->GetResponseInfo());
+  if (response_info.is_null()) {
+    LOG_ERROR("URLLoader::GetResponseInfo returned null");
+    return PP_ERROR_FAILED;
+  }
+
+  response->status_code = response_info.GetStatusCode();
+  if (response->status_code >= 400) {
+    LOG_ERROR("Unexpected HTTP status code: %d", response->status_code);
+    return PP_ERROR_FAILED;
+  }
+
+  pp::Var headers = response_info.GetHeaders();
+  *content_length =
+      headers.is_string() ? ContentLengthFromHeaders(headers.AsString()) : -1;
+  return PP_OK;
+}
+
+}  // anonymous namespace
+
+int32_t PepperTransport::Fetch(const HttpRequest& http_request,
+                               const DownloadDataCallback& on_data,
+                               HttpResponseInfo* response) {
+  using std::chrono::steady_clock;
+  using std::chrono::duration;
+
+  if (pp::MessageLoop::GetCurrent().is_null())
+    return PP_ERROR_NO_MESSAGE_LOOP;
+
+  auto start = steady_clock::now();
+  pp::URLLoader loader(CurrentInstanceHandle());
+  int64_t total_bytes = -1;
+  int32_t ret = OpenURLRequest(ToPepperRequest(http_request), &loader,
+                               &total_bytes, response);
+  if (ret != PP_OK)
+    return ret;
+  response->timing.first_byte =
+      duration<double>(steady_clock::now() - start).count();
+
+  // Left uninitialized, it's only ever read after it's written.
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[kReadBufferSize]);
+  while (true) {
+    ret = loader.ReadResponseBody(buffer.get(), kReadBufferSize,
+                                  pp::CompletionCallback());
+    if (ret < 0) {
+      LOG_ERROR("Failed to ReadResponseBody, result: %d", ret);
+      return PP_ERROR_FAILED;
+    }
+
+    if (ret == PP_OK) break;
+
+    if (!on_data(buffer.get(), ret, total_bytes)) {
+      loader.Close();
+      return PP_ERROR_ABORTED;
+    }
+  }
+  response->timing.total =
+      duration<double>(steady_clock::now() - start).count();
+  return PP_OK;
+}
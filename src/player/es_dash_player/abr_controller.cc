@@ -0,0 +1,209 @@
+/*!
+ * abr_controller.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "abr_controller.h"
+
+#include <algorithm>
+
+#include "common.h"
+
+AbrController::AbrController(
+    const std::vector<AbrRepresentation>& representations,
+    std::shared_ptr<BandwidthEstimator> estimator,
+    AbrPolicyType policy_type,
+    const AbrConfig& config)
+    : representations_(representations),
+      estimator_(std::move(estimator)),
+      policy_(AbrPolicy::Create(policy_type, config)),
+      config_(config),
+      reserved_bandwidth_(0.),
+      ramping_up_(false) {
+  std::stable_sort(representations_.begin(), representations_.end(),
+      [](const AbrRepresentation& a, const AbrRepresentation& b) {
+        return a.bitrate < b.bitrate;
+      });
+  eligible_ = representations_;
+  const char* policy_name = "throughput based";
+  if (policy_type == AbrPolicyType::kBufferBased)
+    policy_name = "buffer based";
+  else if (policy_type == AbrPolicyType::kModelPredictive)
+    policy_name = "model predictive";
+  LOG_INFO("Using %s bitrate adaptation", policy_name);
+}
+
+bool AbrController::SetResolutionCap(const VideoResolution& cap) {
+  std::vector<AbrRepresentation> eligible;
+  for (const auto& representation : representations_) {
+    if (FitsResolutionCap(representation, cap))
+      eligible.push_back(representation);
+  }
+  // Play at least something, even if a cap is below the lowest resolution.
+  if (eligible.empty() && !representations_.empty())
+    eligible.push_back(representations_.front());
+
+  bool changed = eligible.size() != eligible_.size() ||
+      !std::equal(eligible.begin(), eligible.end(), eligible_.begin(),
+                  [](const AbrRepresentation& a, const AbrRepresentation& b) {
+                    return a.id == b.id;
+                  });
+  eligible_ = std::move(eligible);
+  if (changed) {
+    LOG_INFO("Resolution cap: %u x %u, %zu of %zu representations eligible",
+             cap.width, cap.height, eligible_.size(), representations_.size());
+  }
+  return changed;
+}
+
+bool AbrController::IsEligible(uint32_t id) const {
+  return std::any_of(eligible_.begin(), eligible_.end(),
+                     [id](const AbrRepresentation& r) { return r.id == id; });
+}
+
+uint32_t AbrController::SelectInitialRepresentation() {
+  if (eligible_.empty())
+    return 0;
+  AbrContext context = {&eligible_, 0, 0., 0., AvailableBandwidth(),
+                        nullptr};
+  ramping_up_ = true;
+  return eligible_[policy_->SelectInitialRepresentation(context)].id;
+}
+
+uint32_t AbrController::SelectRepresentation(uint32_t current_id,
+                                             double playback_time,
+                                             double buffer_level) {
+  auto current = std::find_if(representations_.begin(),
+      representations_.end(), [current_id](const AbrRepresentation& r) {
+        return r.id == current_id;
+      });
+  if (current == representations_.end() || eligible_.empty())
+    return current_id;
+
+  if (ramping_up_) {
+    if (!estimator_->HasEstimate())
+      return current_id;
+    ramping_up_ = false;
+    auto ramp_up = RampUp(*current);
+    if (ramp_up)
+      return ramp_up->id;
+  }
+
+  // If a current representation is above a resolution cap, a policy decides
+  // as if the highest eligible one below it was current, and a switch
+  // happens anyway.
+  size_t current_index = 0;
+  for (size_t i = 0; i < eligible_.size(); ++i) {
+    if (eligible_[i].bitrate <= current->bitrate)
+      current_index = i;
+    if (eligible_[i].id == current_id)
+      break;
+  }
+
+  // A next segment starts where buffered media ends.
+  std::vector<std::vector<AbrSegment>> upcoming;
+  UpcomingSegments(playback_time + buffer_level, &upcoming);
+  AbrContext context = {&eligible_, current_index, playback_time,
+                        buffer_level, AvailableBandwidth(),
+                        upcoming.empty() ? nullptr : &upcoming};
+  const auto& selected = eligible_[policy_->SelectRepresentation(context)];
+  if (selected.id != current_id) {
+    LOG_INFO("Switching representation %u (%u bps) -> %u (%u bps), estimated "
+             "bandwidth: %.0f bps, buffered: %.2f [s]", current->id,
+             current->bitrate, selected.id, selected.bitrate,
+             context.bandwidth, buffer_level);
+  }
+  return selected.id;
+}
+
+uint32_t AbrController::SelectRepresentationAfterAbandonment(
+    uint32_t current_id, double playback_time, double buffer_level) {
+  ramping_up_ = false;
+  auto selected_id = SelectRepresentation(current_id, playback_time,
+                                          buffer_level);
+  auto current_bitrate = Bitrate(current_id);
+  if (Bitrate(selected_id) < current_bitrate)
+    return selected_id;
+  // A bandwidth estimate didn't catch up with a drop which made a download
+  // miss its deadline, step down anyway.
+  auto lower = std::find_if(eligible_.rbegin(), eligible_.rend(),
+      [current_bitrate](const AbrRepresentation& r) {
+        return r.bitrate < current_bitrate;
+      });
+  if (lower == eligible_.rend())
+    return selected_id;
+  LOG_INFO("Switching representation %u (%u bps) -> %u (%u bps) after an "
+           "abandoned download", current_id, current_bitrate, lower->id,
+           lower->bitrate);
+  return lower->id;
+}
+
+bool AbrController::HasLowerRepresentation(uint32_t id) const {
+  return !eligible_.empty() && eligible_.front().bitrate < Bitrate(id);
+}
+
+uint32_t AbrController::Bitrate(uint32_t id) const {
+  auto representation = std::find_if(representations_.begin(),
+      representations_.end(), [id](const AbrRepresentation& r) {
+        return r.id == id;
+      });
+  return representation == representations_.end() ? 0 :
+                                                    representation->bitrate;
+}
+
+double AbrController::AvailableBandwidth() const {
+  return std::max(estimator_->GetEstimate() - reserved_bandwidth_, 0.);
+}
+
+const AbrRepresentation* AbrController::RampUp(
+    const AbrRepresentation& current) {
+  auto bandwidth = AvailableBandwidth();
+  const AbrRepresentation* sustainable = nullptr;
+  for (const auto& representation : eligible_) {
+    if (representation.bitrate <= bandwidth * config_.safety_margin)
+      sustainable = &representation;
+  }
+  if (!sustainable || sustainable->bitrate <= current.bitrate)
+    return nullptr;
+  LOG_INFO("Ramping up representation %u (%u bps) -> %u (%u bps), measured "
+           "bandwidth: %.0f bps", current.id, current.bitrate,
+           sustainable->id, sustainable->bitrate, bandwidth);
+  return sustainable;
+}
+
+void AbrController::UpcomingSegments(double time,
+    std::vector<std::vector<AbrSegment>>* upcoming) const {
+  auto count = policy_->LookaheadSegments();
+  if (!segment_lookup_ || !count)
+    return;
+
+  for (const auto& representation : eligible_) {
+    auto segments = segment_lookup_(representation.id, time, count);
+    for (auto& segment : segments) {
+      if (segment.size < 0)
+        segment.size = representation.bitrate * segment.duration / 8.;
+    }
+    count = std::min(count, segments.size());
+    upcoming->push_back(std::move(segments));
+  }
+  // Representations may end at slightly different times, a plan can't be
+  // longer than the shortest one.
+  if (!count) {
+    upcoming->clear();
+    return;
+  }
+  for (auto& segments : *upcoming)
+    segments.resize(count);
+}
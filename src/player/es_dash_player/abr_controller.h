@@ -0,0 +1,118 @@
+/*!
+ * abr_controller.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ABR_CONTROLLER_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ABR_CONTROLLER_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "abr_policy.h"
+#include "bandwidth_estimator.h"
+#include "resolution_cap.h"
+
+// Chooses a representation of a stream for a next media segment. A choice is
+// delegated to an AbrPolicy, this class gathers inputs of a decision and
+// translates between representation ids and a bitrate ladder.
+class AbrController {
+ public:
+  // Returns up to count segments of a representation with a given id,
+  // starting at a segment which contains time.
+  typedef std::function<std::vector<AbrSegment>(uint32_t id, double time,
+                                                size_t count)>
+      SegmentLookup;
+
+  AbrController(const std::vector<AbrRepresentation>& representations,
+                std::shared_ptr<BandwidthEstimator> estimator,
+                AbrPolicyType policy_type = AbrPolicyType::kThroughput,
+                const AbrConfig& config = AbrConfig());
+
+  // Sets bandwidth used by other streams (i.e. audio), which isn't available
+  // for this stream.
+  void SetReservedBandwidth(double bits_per_second) {
+    reserved_bandwidth_ = bits_per_second;
+  }
+
+  // Limits representations which may be selected to ones which fit in a
+  // given cap (see ComputeResolutionCap()). Returns true if a set of eligible
+  // representations changed.
+  bool SetResolutionCap(const VideoResolution& cap);
+
+  bool IsEligible(uint32_t id) const;
+
+  // Provides upcoming segments of representations to a policy which looks
+  // ahead (see AbrPolicy::LookaheadSegments()).
+  void SetSegmentLookup(SegmentLookup lookup) {
+    segment_lookup_ = std::move(lookup);
+  }
+
+  // Returns an id of a representation to start a playback with. It is chosen
+  // by an initial estimate of bandwidth, so it's held until first segments
+  // measure throughput. Then SelectRepresentation() ramps up right away to
+  // the highest representation the throughput sustains, and a policy takes
+  // over.
+  uint32_t SelectInitialRepresentation();
+
+  // Returns an id of a representation to be used for a next segment.
+  // buffer_level is a time (in seconds) of media buffered ahead of
+  // playback_time.
+  uint32_t SelectRepresentation(uint32_t current_id, double playback_time,
+                                double buffer_level);
+
+  // Like SelectRepresentation(), but called when a download of a segment in
+  // a current representation was abandoned. A returned representation is
+  // always lower than a current one, if there is any.
+  uint32_t SelectRepresentationAfterAbandonment(uint32_t current_id,
+                                                double playback_time,
+                                                double buffer_level);
+
+  // Checks if there is an eligible representation with a lower bitrate than
+  // a given one.
+  bool HasLowerRepresentation(uint32_t id) const;
+
+ private:
+  // Returns a bitrate of a given representation, or 0 if it's unknown.
+  uint32_t Bitrate(uint32_t id) const;
+
+  double AvailableBandwidth() const;
+
+  // Returns a representation to switch to at the end of a ramp-up, or
+  // nullptr if a current one is to be kept.
+  const AbrRepresentation* RampUp(const AbrRepresentation& current);
+
+  // Fills upcoming with segments of eligible representations starting at a
+  // given time, or leaves it empty if they aren't known.
+  void UpcomingSegments(double time,
+                        std::vector<std::vector<AbrSegment>>* upcoming) const;
+
+  // Sorted by bitrate, lowest first.
+  std::vector<AbrRepresentation> representations_;
+  // Representations within a resolution cap, sorted as above. Never empty,
+  // unless representations_ is.
+  std::vector<AbrRepresentation> eligible_;
+  std::shared_ptr<BandwidthEstimator> estimator_;
+  std::unique_ptr<AbrPolicy> policy_;
+  SegmentLookup segment_lookup_;
+  AbrConfig config_;
+  double reserved_bandwidth_;
+  bool ramping_up_;
+};
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ABR_CONTROLLER_H_
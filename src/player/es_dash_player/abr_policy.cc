@@ -0,0 +1,212 @@
+/*!
+ * abr_policy.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "abr_policy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::unique_ptr<AbrPolicy> AbrPolicy::Create(AbrPolicyType type,
+                                             const AbrConfig& config) {
+  switch (type) {
+    case AbrPolicyType::kBufferBased:
+      return MakeUnique<BufferAbrPolicy>(config);
+    case AbrPolicyType::kModelPredictive:
+      return MakeUnique<ModelPredictiveAbrPolicy>(config);
+    case AbrPolicyType::kThroughput:
+    default:
+      return MakeUnique<ThroughputAbrPolicy>(config);
+  }
+}
+
+size_t AbrPolicy::HighestFitting(const AbrContext& context,
+                                 double bits_per_second) {
+  const auto& representations = *context.representations;
+  size_t fitting = 0;
+  for (size_t i = 0; i < representations.size(); ++i) {
+    if (representations[i].bitrate <= bits_per_second)
+      fitting = i;
+  }
+  return fitting;
+}
+
+double AbrPolicy::Utility(const AbrContext& context, size_t index) {
+  const auto& representations = *context.representations;
+  double lowest_bitrate = std::max(representations.front().bitrate, 1u);
+  double bitrate = std::max(representations[index].bitrate, 1u);
+  return std::log(bitrate / lowest_bitrate) + 1.;
+}
+
+ThroughputAbrPolicy::ThroughputAbrPolicy(const AbrConfig& config)
+    : config_(config),
+      switched_(false),
+      last_switch_time_(0.) {
+}
+
+size_t ThroughputAbrPolicy::SelectInitialRepresentation(
+    const AbrContext& context) {
+  return HighestFitting(context, context.bandwidth * config_.safety_margin);
+}
+
+size_t ThroughputAbrPolicy::SelectRepresentation(const AbrContext& context) {
+  const auto& representations = *context.representations;
+  auto current_bitrate = representations[context.current].bitrate;
+  auto candidate =
+      HighestFitting(context, context.bandwidth * config_.safety_margin);
+  auto candidate_bitrate = representations[candidate].bitrate;
+  if (candidate_bitrate > current_bitrate) {
+    // Playback time goes back after a seek, which doesn't hold a switch.
+    if (switched_ && context.playback_time >= last_switch_time_ &&
+        context.playback_time - last_switch_time_ <
+            config_.min_up_switch_interval)
+      return context.current;
+  } else if (candidate_bitrate == current_bitrate ||
+             current_bitrate <= context.bandwidth * config_.keep_margin) {
+    return context.current;
+  }
+
+  switched_ = true;
+  last_switch_time_ = context.playback_time;
+  return candidate;
+}
+
+BufferAbrPolicy::BufferAbrPolicy(const AbrConfig& config)
+    : config_(config),
+      selected_(0),
+      switched_(false),
+      last_switch_time_(0.) {
+}
+
+size_t BufferAbrPolicy::SelectInitialRepresentation(
+    const AbrContext& context) {
+  selected_ =
+      HighestFitting(context, context.bandwidth * config_.safety_margin);
+  return selected_;
+}
+
+size_t BufferAbrPolicy::SelectRepresentation(const AbrContext& context) {
+  // A switch may also be forced by a caller, e.g. after an abandoned
+  // download.
+  if (context.current != selected_) {
+    switched_ = true;
+    last_switch_time_ = context.playback_time;
+  }
+  selected_ = context.current;
+  const auto& representations = *context.representations;
+  double highest_utility = Utility(context, representations.size() - 1);
+  double buffer_ratio =
+      config_.target_buffer_level / config_.min_buffer_level;
+  if (highest_utility <= 1. || buffer_ratio <= 1.)
+    return context.current;
+  double gamma = (highest_utility - 1.) / (buffer_ratio - 1.);
+  double v = config_.min_buffer_level / gamma;
+
+  size_t best = 0;
+  double best_score = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < representations.size(); ++i) {
+    double bitrate = std::max(representations[i].bitrate, 1u);
+    double score =
+        (v * (Utility(context, i) + gamma) - context.buffer_level) / bitrate;
+    if (score >= best_score) {
+      best = i;
+      best_score = score;
+    }
+  }
+
+  if (best > context.current) {
+    // Don't switch up beyond a representation a network sustains, but don't
+    // force switching down either - the buffer level will (BOLA-O). Playback
+    // time goes back after a seek, which doesn't hold a switch.
+    auto sustainable =
+        HighestFitting(context, context.bandwidth * config_.safety_margin);
+    best = std::max(context.current, std::min(best, sustainable));
+    if (switched_ && context.playback_time >= last_switch_time_ &&
+        context.playback_time - last_switch_time_ <
+            config_.min_up_switch_interval)
+      best = context.current;
+  }
+  if (best != context.current) {
+    switched_ = true;
+    last_switch_time_ = context.playback_time;
+  }
+  selected_ = best;
+  return best;
+}
+
+ModelPredictiveAbrPolicy::ModelPredictiveAbrPolicy(const AbrConfig& config)
+    : config_(config),
+      fallback_(config) {
+}
+
+size_t ModelPredictiveAbrPolicy::SelectInitialRepresentation(
+    const AbrContext& context) {
+  return HighestFitting(context, context.bandwidth * config_.safety_margin);
+}
+
+size_t ModelPredictiveAbrPolicy::SelectRepresentation(
+    const AbrContext& context) {
+  // A throughput is predicted conservatively, as a current representation's
+  // bitrate is checked by ThroughputAbrPolicy.
+  double throughput = context.bandwidth * config_.keep_margin;
+  if (!context.upcoming_segments || throughput <= 0.)
+    return fallback_.SelectRepresentation(context);
+
+  size_t best = context.current;
+  double best_score = -std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < context.representations->size(); ++i) {
+    double score = PlanScore(context, throughput, 0, i, context.current,
+                             context.buffer_level);
+    // Ties are resolved in favour of a current representation.
+    if (score > best_score + kEps ||
+        (score > best_score - kEps && i == context.current)) {
+      best = i;
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+double ModelPredictiveAbrPolicy::PlanScore(const AbrContext& context,
+    double throughput, size_t segment, size_t index, size_t previous_index,
+    double buffer_level) const {
+  const auto& upcoming = (*context.upcoming_segments)[index];
+  const auto& next = upcoming[segment];
+  double download_time = next.size * 8. / throughput;
+  double stall_time = std::max(download_time - buffer_level, 0.);
+  buffer_level = std::max(buffer_level - download_time, 0.) + next.duration;
+  // A stream doesn't request segments above a target buffer level, so
+  // playback drains the rest before a next download.
+  buffer_level = std::min(buffer_level, config_.target_buffer_level);
+
+  double utility = Utility(context, index);
+  double score = utility - config_.stall_penalty * stall_time -
+      config_.switch_penalty *
+          std::fabs(utility - Utility(context, previous_index));
+  if (segment + 1 >= upcoming.size())
+    return score;
+
+  double best_rest = -std::numeric_limits<double>::infinity();
+  size_t lowest = index > 0 ? index - 1 : 0;
+  size_t highest = std::min(index + 1, context.representations->size() - 1);
+  for (size_t i = lowest; i <= highest; ++i) {
+    best_rest = std::max(best_rest, PlanScore(context, throughput,
+                                              segment + 1, i, index,
+                                              buffer_level));
+  }
+  return score + best_rest;
+}
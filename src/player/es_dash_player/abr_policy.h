@@ -0,0 +1,204 @@
+/*!
+ * abr_policy.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ABR_POLICY_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ABR_POLICY_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "common.h"
+
+// A representation as seen by bitrate adaptation.
+struct AbrRepresentation {
+  uint32_t id;
+  uint32_t bitrate;  // in bits per second
+  uint32_t width;    // 0 if unknown (e.g. for audio)
+  uint32_t height;
+};
+
+// An upcoming media segment of a representation.
+struct AbrSegment {
+  double duration;  // in seconds
+  int64_t size;     // in bytes, negative if unknown
+};
+
+struct AbrConfig {
+  // A part of an estimated bandwidth a representation may use to be chosen.
+  double safety_margin;
+  // A current representation is kept as long as it uses at most this part of
+  // an estimated bandwidth. A gap between this and safety_margin prevents
+  // switching back and forth when an estimate fluctuates.
+  double keep_margin;
+  // Minimal playback time (in seconds) after a switch before switching up.
+  // Used by throughput and buffer based policies.
+  double min_up_switch_interval;
+  // Buffer levels (in seconds) between which a buffer based policy spreads
+  // representations. Below the minimum the lowest one is chosen. A stream
+  // doesn't buffer much more than the target (see StreamManager).
+  double min_buffer_level;
+  double target_buffer_level;
+  // A number of upcoming segments a model predictive policy plans.
+  size_t lookahead_segments;
+  // Costs a model predictive policy weighs against a utility of a segment
+  // (which is 1 for the lowest representation): of a second of a stall and
+  // of a switch, per a unit of a utility difference.
+  double stall_penalty;
+  double switch_penalty;
+
+  AbrConfig()
+      : safety_margin(0.7),
+        keep_margin(0.9),
+        min_up_switch_interval(10.),
+        min_buffer_level(2.),
+        target_buffer_level(7.),
+        lookahead_segments(5),
+        stall_penalty(50.),
+        switch_penalty(1.) {}
+};
+
+// Inputs of a single representation decision.
+struct AbrContext {
+  // Sorted by bitrate, lowest first. Never empty.
+  const std::vector<AbrRepresentation>* representations;
+  // Index of a current representation in representations.
+  size_t current;
+  double playback_time;
+  // Media buffered ahead of playback_time, in seconds.
+  double buffer_level;
+  // Estimated bandwidth available for a stream, in bits per second.
+  double bandwidth;
+  // Upcoming segments of each representation, starting at a next segment to
+  // be requested, or nullptr if a policy doesn't look ahead (see
+  // AbrPolicy::LookaheadSegments()). If set, every representation has the
+  // same, non-zero number of segments. Unknown sizes are derived from a
+  // bitrate.
+  const std::vector<std::vector<AbrSegment>>* upcoming_segments;
+};
+
+// A strategy of choosing a representation for a next media segment.
+class AbrPolicy {
+ public:
+  static std::unique_ptr<AbrPolicy> Create(AbrPolicyType type,
+                                           const AbrConfig& config);
+
+  virtual ~AbrPolicy() = default;
+
+  // Returns an index of a representation to start a playback with.
+  // context.current and context.buffer_level are not meaningful.
+  virtual size_t SelectInitialRepresentation(const AbrContext& context) = 0;
+
+  // Returns an index of a representation for a next segment.
+  virtual size_t SelectRepresentation(const AbrContext& context) = 0;
+
+  // Returns a number of upcoming segments a policy needs to know (see
+  // AbrContext::upcoming_segments).
+  virtual size_t LookaheadSegments() const { return 0; }
+
+ protected:
+  // Returns a utility of a representation: ln(bitrate / lowest bitrate) + 1,
+  // so the lowest representation has a utility of 1.
+  static double Utility(const AbrContext& context, size_t index);
+
+  // Returns the highest representation with a bitrate not higher than
+  // bits_per_second, or the lowest representation if none fits.
+  static size_t HighestFitting(const AbrContext& context,
+                               double bits_per_second);
+};
+
+// Chooses representations by an estimated throughput.
+//
+// Switching down happens as soon as a current representation doesn't fit
+// within keep_margin of an estimate. Switching up requires a representation
+// to fit within safety_margin and is done at most once per
+// min_up_switch_interval.
+class ThroughputAbrPolicy : public AbrPolicy {
+ public:
+  explicit ThroughputAbrPolicy(const AbrConfig& config);
+  size_t SelectInitialRepresentation(const AbrContext& context) override;
+  size_t SelectRepresentation(const AbrContext& context) override;
+
+ private:
+  AbrConfig config_;
+  bool switched_;
+  double last_switch_time_;
+};
+
+// Chooses representations by a buffer level, using BOLA utility
+// maximization (see "BOLA: Near-Optimal Bitrate Adaptation for Online
+// Videos", Spiteri et al.). Each representation is given a utility
+// ln(bitrate / lowest bitrate) and a representation maximizing
+// (V * (utility + gamma) - buffer_level) / bitrate is chosen, where V and
+// gamma are derived from min_buffer_level and target_buffer_level.
+//
+// A throughput estimate is used only to choose a start representation and to
+// stop switching up beyond what a network sustains (like BOLA-O). A target
+// buffer is only a few segments long, so without that a buffer alone would
+// switch up whenever it fills and back down as it drains. Switching up is
+// also done at most once per min_up_switch_interval.
+class BufferAbrPolicy : public AbrPolicy {
+ public:
+  explicit BufferAbrPolicy(const AbrConfig& config);
+  size_t SelectInitialRepresentation(const AbrContext& context) override;
+  size_t SelectRepresentation(const AbrContext& context) override;
+
+ private:
+  AbrConfig config_;
+  // A representation chosen last time, to notice switches forced by a caller.
+  size_t selected_;
+  bool switched_;
+  double last_switch_time_;
+};
+
+// Chooses representations by planning a few upcoming segments (see "A
+// Control-Theoretic Approach for Dynamic Adaptive Video Streaming over HTTP",
+// Yin et al.). Every plan of representations for lookahead_segments
+// segments is played over a model of a buffer, in which each segment is
+// downloaded at a predicted throughput, and a plan maximizing a total utility
+// less stall and switch penalties is chosen. Only a first segment of the
+// plan is requested, a next decision makes a new plan.
+//
+// Actual segment sizes (e.g. from a sidx box) make the model see bitrate
+// peaks of VBR content, so a representation which stalls on a peak isn't
+// chosen even if its average bitrate fits. Consecutive segments of a plan
+// differ by at most one representation, which keeps a search small.
+//
+// Without upcoming segments it behaves as ThroughputAbrPolicy.
+class ModelPredictiveAbrPolicy : public AbrPolicy {
+ public:
+  explicit ModelPredictiveAbrPolicy(const AbrConfig& config);
+  size_t SelectInitialRepresentation(const AbrContext& context) override;
+  size_t SelectRepresentation(const AbrContext& context) override;
+  size_t LookaheadSegments() const override {
+    return config_.lookahead_segments;
+  }
+
+ private:
+  // Returns a best score of plans starting at a given segment, which is
+  // downloaded from a representation with a given index, after a previous
+  // one was downloaded from previous_index.
+  double PlanScore(const AbrContext& context, double throughput,
+                   size_t segment, size_t index, size_t previous_index,
+                   double buffer_level) const;
+
+  AbrConfig config_;
+  ThroughputAbrPolicy fallback_;
+};
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ABR_POLICY_H_
@@ -19,8 +19,12 @@
 
 #include "async_data_provider.h"
 
+#include <algorithm>
 #include <cmath>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include <string>
 
 #include "libdash/libdash.h"
@@ -28,6 +32,7 @@
 #include "common.h"
 #include "dash/media_segment_sequence.h"
 
+#include "buffering_policy.h"
 #include "media_segment.h"
 
 using pp::AutoLock;
@@ -36,7 +41,37 @@ using std::unique_ptr;
 using std::vector;
 
 namespace {
-const uint32_t kDefaultSegmentSize = 32 * 1024;
+// A size of segment chunks passed on while a segment is downloaded.
+const size_t kChunkSize = 64 * 1024;
+// A segment is split into parts of at least this size, so smaller segments
+// are downloaded over a single connection.
+const int64_t kMinPartSize = 1024 * 1024;
+// How often progress is reported while parts of a segment are awaited.
+constexpr std::chrono::milliseconds kPartProgressInterval{100};
+
+std::atomic<uint32_t> parallel_connections(1);
+
+// Identifies a segment by its URL and a byte range.
+std::string SegmentKey(dash::mpd::ISegment* segment) {
+  auto chunk = static_cast<dash::network::IChunk*>(segment);
+  std::string key = chunk->AbsoluteURI();
+  if (chunk->HasByteRange())
+    key += " Range: " + chunk->Range();
+  return key;
+}
+
+// Returns a size of the largest segment of a sequence, or 0 if sizes of
+// segments aren't known in advance (i.e. a sequence has no segment index).
+size_t LargestSegmentSize(const MediaSegmentSequence& sequence) {
+  int64_t largest = 0;
+  for (auto it = sequence.Begin(); it != sequence.End(); ++it) {
+    int64_t size = sequence.SegmentSize(it);
+    if (size < 0)
+      return 0;
+    largest = std::max(largest, size);
+  }
+  return largest;
+}
 }
 
 AsyncDataProvider::AsyncDataProvider(
@@ -44,14 +79,25 @@ AsyncDataProvider::AsyncDataProvider(
     std::function<void(std::unique_ptr<MediaSegment>)> callback)
     : own_thread_(instance),
       next_segment_iterator_(),
+      init_segment_pending_(false),
+      request_generation_(0),
       iterator_lock_(),
       cc_factory_(this),
-      last_segment_size_(kDefaultSegmentSize),
+      buffer_pool_(std::make_shared<SegmentBufferPool>()),
       data_segment_callback_(callback) {
   own_thread_.Start();
+  for (uint32_t i = 1; i < parallel_connections; ++i) {
+    part_threads_.emplace_back(new pp::SimpleThread(instance));
+    part_threads_.back()->Start();
+  }
+}
+
+void AsyncDataProvider::SetParallelConnections(uint32_t connections) {
+  LOG_INFO("Downloading large segments over %u connections.", connections);
+  parallel_connections = std::max(connections, 1u);
 }
 
-bool AsyncDataProvider::RequestNextDataSegment() {
+bool AsyncDataProvider::RequestNextDataSegment(double deadline) {
   LOG_DEBUG("Requesting next data segment");
   AutoLock lock(iterator_lock_);
   if (next_segment_iterator_ == sequence_->End()) {
@@ -66,9 +112,17 @@ bool AsyncDataProvider::RequestNextDataSegment() {
     return false;
   }
 
+  SegmentRequest request;
+  request.sequence = sequence_;
+  request.segment_iterator = next_segment_iterator_++;
+  request.with_init_segment = init_segment_pending_;
+  request.deadline = deadline;
+  request.generation = request_generation_;
+  init_segment_pending_ = false;
+
   int32_t result = own_thread_.message_loop().PostWork(cc_factory_.NewCallback(
-      &AsyncDataProvider::DownloadNextSegmentOnOwnThread,
-      next_segment_iterator_++, destination_message_loop));
+      &AsyncDataProvider::DownloadNextSegmentOnOwnThread, request,
+      destination_message_loop));
 
   if (result != PP_OK) {
     return false;
@@ -84,6 +138,8 @@ bool AsyncDataProvider::SetNextSegmentToTime(double time) {
     return false;
   }
   next_segment_iterator_ = sequence_->MediaSegmentForTime(time);
+  // After a seek an initialization segment is parsed by a caller.
+  init_segment_pending_ = false;
   if (next_segment_iterator_ == sequence_->End()) {
     LOG_ERROR("Can't find segment for time: %f", time);
     return false;
@@ -92,6 +148,11 @@ bool AsyncDataProvider::SetNextSegmentToTime(double time) {
   return true;
 }
 
+void AsyncDataProvider::CancelPendingRequests() {
+  LOG_DEBUG("Cancelling pending segment requests.");
+  ++request_generation_;
+}
+
 Samsung::NaClPlayer::TimeTicks AsyncDataProvider::GetClosestKeyframeTime(
     Samsung::NaClPlayer::TimeTicks time) {
   constexpr Samsung::NaClPlayer::TimeTicks kSeekMargin = 0.1;
@@ -112,10 +173,33 @@ Samsung::NaClPlayer::TimeTicks AsyncDataProvider::GetClosestKeyframeTime(
   return next_segment_start + kSeekMargin;
 }
 
+Samsung::NaClPlayer::TimeTicks AsyncDataProvider::GetSegmentStartTime(
+    Samsung::NaClPlayer::TimeTicks time) {
+  AutoLock lock(iterator_lock_);
+  if (!sequence_)
+    return time;
+  auto segment = sequence_->MediaSegmentForTime(time);
+  if (segment == sequence_->End())
+    return time;
+  return segment.SegmentTimestamp(sequence_.get());
+}
+
+void AsyncDataProvider::RewindToSegment(double timestamp,
+                                        bool with_init_segment) {
+  AutoLock lock(iterator_lock_);
+  if (!sequence_)
+    return;
+  next_segment_iterator_ =
+      sequence_->MediaSegmentForTime(timestamp + kSegmentMargin);
+  init_segment_pending_ |= with_init_segment;
+}
+
 void AsyncDataProvider::SetMediaSegmentSequence(
     std::unique_ptr<MediaSegmentSequence> sequence, double time) {
   AutoLock lock(iterator_lock_);
   sequence_ = std::move(sequence);
+  init_segment_pending_ = false;
+  UpdateBufferSize();
   if (fabs(time) < kEps) {
     next_segment_iterator_ = sequence_->Begin();
   } else {
@@ -123,6 +207,28 @@ void AsyncDataProvider::SetMediaSegmentSequence(
   }
 }
 
+void AsyncDataProvider::SwitchMediaSegmentSequence(
+    std::unique_ptr<MediaSegmentSequence> sequence) {
+  AutoLock lock(iterator_lock_);
+  if (!sequence_ || next_segment_iterator_ == sequence_->End()) {
+    LOG_INFO("No more segments in a current sequence.");
+    sequence_ = std::move(sequence);
+    next_segment_iterator_ = sequence_->End();
+    init_segment_pending_ = false;
+    return;
+  }
+  auto boundary = next_segment_iterator_.SegmentTimestamp(sequence_.get());
+  sequence_ = std::move(sequence);
+  UpdateBufferSize();
+  // Segments of all representations are expected to be aligned, kSegmentMargin
+  // protects against rounding errors when looking up a segment.
+  next_segment_iterator_ =
+      sequence_->MediaSegmentForTime(boundary + kSegmentMargin);
+  init_segment_pending_ = true;
+  LOG_INFO("New sequence starts at %f [s]",
+           next_segment_iterator_.SegmentTimestamp(sequence_.get()));
+}
+
 double AsyncDataProvider::AverageSegmentDuration() {
   if (!sequence_) {
     return 0.0;
@@ -130,45 +236,188 @@ double AsyncDataProvider::AverageSegmentDuration() {
   return sequence_->AverageSegmentDuration();
 }
 
+void AsyncDataProvider::UpdatePlaybackPosition(
+    Samsung::NaClPlayer::TimeTicks time) {
+  recent_segments_.SetPlaybackPosition(time);
+  recent_segments_.ReleaseUnderPressure();
+  buffer_pool_->ReleaseUnderPressure();
+  buffer_pool_->ReportStatistics();
+}
+
+void AsyncDataProvider::UpdateBufferSize() {
+  // Without a segment index the pool learns a size from downloaded segments.
+  size_t largest = LargestSegmentSize(*sequence_);
+  if (largest)
+    buffer_pool_->SetBufferSize(largest);
+}
+
 bool AsyncDataProvider::GetInitSegment(std::vector<uint8_t>* buffer) {
   return DownloadSegment(sequence_->GetInitSegment(), buffer);
 }
 
 void AsyncDataProvider::DownloadNextSegmentOnOwnThread(
-    int32_t, MediaSegmentSequence::Iterator segment_iterator,
+    int32_t, const SegmentRequest& request,
     MessageLoop destination_message_loop) {
   using std::chrono::steady_clock;
   using std::chrono::duration_cast;
   using std::chrono::duration;
 
-  auto segment_duration = sequence_->SegmentDuration(segment_iterator);
-  auto segment_timestamp = sequence_->SegmentTimestamp(segment_iterator);
+  const auto& sequence = request.sequence;
+  const auto& segment_iterator = request.segment_iterator;
+  auto segment_duration = sequence->SegmentDuration(segment_iterator);
+  auto segment_timestamp = sequence->SegmentTimestamp(segment_iterator);
   auto st = steady_clock::now();
+  if (IsCancelled(request)) {
+    LOG_DEBUG("A request for a segment: %f [s] was cancelled.",
+        segment_timestamp);
+    return;
+  }
   LOG_DEBUG("Starting download for a segment: %f [s] ... %f [s]",
       segment_timestamp, segment_timestamp + segment_duration);
   auto seg = MakeUnique<MediaSegment>();
-
-  // arbitrary additional buffer space if segments size varies a little
-  seg->data_.reserve(last_segment_size_ + last_segment_size_ / 32);
   seg->duration_ = segment_duration;
   seg->timestamp_ = segment_timestamp;
+  seg->with_init_segment_ = request.with_init_segment;
+
+  // Downloads are closed as soon as their request is cancelled.
+  auto not_cancelled = [this, &request](size_t, int64_t) {
+    return !IsCancelled(request);
+  };
+  if (request.with_init_segment) {
+    auto init_segment = sequence->GetInitSegment();
+    auto init_key = SegmentKey(init_segment.get());
+    // An initialization segment is small, so it's copied.
+    auto cached_init = recent_segments_.Get(init_key);
+    if (cached_init) {
+      seg->init_data_ = *cached_init;
+    } else {
+      if (!DownloadSegment(init_segment.get(), &(seg->init_data_),
+                           not_cancelled)) {
+        if (IsCancelled(request))
+          return;
+        LOG_ERROR("Failed to download initialization segment!");
+        return;
+      }
+      recent_segments_.Put(init_key, segment_timestamp,
+                           std::make_shared<vector<uint8_t>>(seg->init_data_));
+    }
+  }
 
   auto segment = *segment_iterator;
-  dash::network::IChunk* chunk =
-      static_cast<dash::network::IChunk*>(segment.get());
-  std::string url = chunk->AbsoluteURI();
-  if (chunk->HasByteRange())
-    url += " Range: " + chunk->Range();
-  if (!DownloadSegment(std::move(segment), &(seg->data_))) {
-    LOG_DEBUG("Download of a segment: %f [s] ... %f [s] was interrupted.",
+  std::string url = SegmentKey(segment.get());
+  auto cached_data = recent_segments_.Get(url);
+  if (cached_data) {
+    // A cached segment is passed on whole and tells nothing about a network.
+    LOG_DEBUG("A segment: %f [s] ... %f [s] was found in memory.",
         segment_timestamp, segment_timestamp + segment_duration);
+    seg->data_ = std::move(cached_data);
+    seg->memory_account_.Set(seg->data_->capacity() +
+                             seg->init_data_.capacity());
+    destination_message_loop.PostWork(cc_factory_.NewCallback(
+        &AsyncDataProvider::PassResultOnCallerThread, seg.release(),
+        request.generation));
     return;
   }
-  last_segment_size_ = seg->data_.size();
+  auto download_start = steady_clock::now();
+  // Times given to the estimator, which merges overlapping downloads.
+  double started_at =
+      duration<double>(download_start.time_since_epoch()).count();
+  auto now = [] {
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+  };
+  size_t seg_data_size = 0;
+  // A segment read from a cache tells nothing about a network.
+  bool cached = false;
+  // A segment known to be too small to be split is streamed as usual.
+  int64_t segment_size = sequence->SegmentSize(segment_iterator);
+  bool in_parts = !part_threads_.empty() &&
+      (segment_size < 0 || segment_size >= 2 * kMinPartSize);
+  if (!std::isfinite(request.deadline) && !in_parts) {
+    // A streamed segment is gathered whole only if it can be kept in memory.
+    // The cache then takes the buffer over, so it isn't copied again, and it
+    // goes back to the pool once it's evicted.
+    bool keep = recent_segments_.Fits(segment_size);
+    vector<uint8_t> segment_data;
+    if (keep)
+      segment_data = buffer_pool_->Acquire();
+    bool streamed = StreamSegmentOnOwnThread(request, segment.get(),
+        std::move(seg), destination_message_loop, &seg_data_size, &cached,
+        keep ? &segment_data : nullptr);
+    if (streamed && keep) {
+      recent_segments_.Put(url, segment_timestamp,
+                           buffer_pool_->Share(std::move(segment_data)));
+    } else {
+      buffer_pool_->Release(std::move(segment_data));
+    }
+    if (!streamed) {
+      LOG_DEBUG("Download of a segment: %f [s] ... %f [s] was interrupted.",
+          segment_timestamp, segment_timestamp + segment_duration);
+      return;
+    }
+    if (bandwidth_estimator_ && !cached)
+      bandwidth_estimator_->AddSample(seg_data_size, started_at, now(),
+                                      segment_duration);
+  } else {
+    size_t abandoned_at = 0;
+    double abandoned_after = 0.;
+    // The deadline counts from the request, a download starts later.
+    duration<double> queued = download_start - st;
+    double deadline = request.deadline - queued.count();
+    auto progress = [&](size_t bytes_received, int64_t total_bytes) {
+      if (IsCancelled(request))
+        return false;
+      duration<double> elapsed = steady_clock::now() - download_start;
+      double projected = 0.;
+      if (!IsDownloadLate(elapsed.count(), bytes_received, total_bytes,
+                          deadline, &projected))
+        return true;
+      LOG_INFO("Abandoning a segment: %f [s], %zu of %lld bytes in %.2f [s], "
+               "projected %.2f [s], deadline %.2f [s]", segment_timestamp,
+               bytes_received, static_cast<long long>(total_bytes),
+               elapsed.count(), projected, deadline);
+      abandoned_at = bytes_received;
+      abandoned_after = elapsed.count();
+      return false;
+    };
+    vector<uint8_t> segment_data = buffer_pool_->Acquire();
+    bool downloaded = in_parts ?
+        DownloadInPartsOnOwnThread(request, segment.get(), segment_size,
+                                   &segment_data, progress) :
+        DownloadSegment(segment.get(), &segment_data, progress, &cached);
+    if (!downloaded) {
+      buffer_pool_->Release(std::move(segment_data));
+      if (abandoned_at) {
+        // A partial download still tells how fast the network is.
+        if (bandwidth_estimator_)
+          bandwidth_estimator_->AddSample(abandoned_at, started_at,
+                                          started_at + abandoned_after, 0.);
+        seg->abandoned_ = true;
+        seg->init_data_.clear();
+        seg->memory_account_.Set(0);
+        destination_message_loop.PostWork(cc_factory_.NewCallback(
+            &AsyncDataProvider::PassResultOnCallerThread, seg.release(),
+            request.generation));
+        return;
+      }
+      LOG_DEBUG("Download of a segment: %f [s] ... %f [s] was interrupted.",
+          segment_timestamp, segment_timestamp + segment_duration);
+      return;
+    }
+    if (bandwidth_estimator_ && !cached)
+      bandwidth_estimator_->AddSample(segment_data.size(), started_at, now(),
+                                      segment_duration);
+    // The segment and the cache share one buffer, which goes back to the
+    // pool once the segment is parsed and the cache evicts it.
+    seg->data_ = buffer_pool_->Share(std::move(segment_data));
+    seg->memory_account_.Set(seg->data_->capacity() +
+                             seg->init_data_.capacity());
+    recent_segments_.Put(url, segment_timestamp, seg->data_);
 
-  size_t seg_data_size = seg->data_.size();
-  destination_message_loop.PostWork(cc_factory_.NewCallback(
-      &AsyncDataProvider::PassResultOnCallerThread, seg.release()));
+    seg_data_size = seg->data_->size();
+    destination_message_loop.PostWork(cc_factory_.NewCallback(
+        &AsyncDataProvider::PassResultOnCallerThread, seg.release(),
+        request.generation));
+  }
 
   auto et = steady_clock::now();
   duration<double> d = et - st;
@@ -180,10 +429,251 @@ void AsyncDataProvider::DownloadNextSegmentOnOwnThread(
         url.c_str());
 }
 
+bool AsyncDataProvider::StreamSegmentOnOwnThread(
+    const SegmentRequest& request, dash::mpd::ISegment* segment,
+    std::unique_ptr<MediaSegment> chunk, MessageLoop destination_message_loop,
+    size_t* bytes_received, bool* cached,
+    std::vector<uint8_t>* segment_data) {
+  auto timestamp = chunk->timestamp_;
+  auto duration = chunk->duration_;
+  chunk->first_chunk_ = true;
+  chunk->last_chunk_ = false;
+  *bytes_received = 0;
+
+  vector<uint8_t> chunk_data;
+  chunk_data.reserve(kChunkSize);
+  auto pass_chunk = [&](bool last) {
+    chunk->last_chunk_ = last;
+    chunk->data_ = std::make_shared<vector<uint8_t>>(std::move(chunk_data));
+    chunk->memory_account_.Set(chunk->data_->capacity() +
+                               chunk->init_data_.capacity());
+    destination_message_loop.PostWork(cc_factory_.NewCallback(
+        &AsyncDataProvider::PassResultOnCallerThread, chunk.release(),
+        request.generation));
+    if (last)
+      return;
+    chunk = MakeUnique<MediaSegment>();
+    chunk->timestamp_ = timestamp;
+    chunk->duration_ = duration;
+    chunk->first_chunk_ = false;
+    chunk->last_chunk_ = false;
+    chunk_data = vector<uint8_t>();
+    chunk_data.reserve(kChunkSize);
+  };
+
+  bool completed = StreamSegment(segment,
+      [&](const uint8_t* data, size_t size, int64_t total_bytes) {
+        if (IsCancelled(request))
+          return false;
+        chunk_data.insert(chunk_data.end(), data, data + size);
+        *bytes_received += size;
+        if (chunk_data.size() >= kChunkSize)
+          pass_chunk(false);
+        return true;
+      }, cached, segment_data);
+  if (!completed)
+    return false;
+  // A segment smaller than a chunk is passed on whole.
+  pass_chunk(true);
+  return true;
+}
+
+struct AsyncDataProvider::PartedDownload {
+  PartedDownload(dash::mpd::ISegment* segment, std::vector<uint8_t>* data)
+      : segment(segment),
+        data(data),
+        parts(1),
+        part_size(0),
+        received(1, 0),
+        parts_started(0),
+        parts_finished(0),
+        fallback(false),
+        aborted(false) {}
+
+  // Owned by a caller, which waits until all parts are finished.
+  dash::mpd::ISegment* segment;
+  std::vector<uint8_t>* data;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  uint32_t parts;
+  uint64_t part_size;
+  // Bytes received by each part.
+  std::vector<size_t> received;
+  // Parts (other than the first one) which received data.
+  uint32_t parts_started;
+  uint32_t parts_finished;
+  // Set if a part can't be downloaded (e.g. a server doesn't support byte
+  // ranges), so the first part goes on to an end of a segment.
+  bool fallback;
+  bool aborted;
+};
+
+bool AsyncDataProvider::DownloadInPartsOnOwnThread(
+    const SegmentRequest& request, dash::mpd::ISegment* segment,
+    int64_t segment_size, std::vector<uint8_t>* data,
+    const DownloadProgressCallback& progress) {
+  auto download = std::make_shared<PartedDownload>(segment, data);
+  auto& d = *download;
+  std::unique_lock<std::mutex> lock(d.mutex);
+  data->clear();
+  if (segment_size > 0)
+    SplitDownload(download, segment_size);
+
+  int64_t expected_size = segment_size;
+  // Must be called with d.mutex locked, it's unlocked for a callback.
+  auto report_progress = [&]() {
+    size_t bytes_received = 0;
+    for (auto part_received : d.received)
+      bytes_received += part_received;
+    int64_t total_bytes = expected_size;
+    lock.unlock();
+    bool proceed = progress(bytes_received, total_bytes);
+    lock.lock();
+    if (!proceed) {
+      d.aborted = true;
+      d.changed.notify_all();
+    }
+    return proceed;
+  };
+
+  // The first part is downloaded on this thread. Until a segment is split, it
+  // downloads a whole segment.
+  bool first_part_done = false;
+  lock.unlock();
+  bool completed = StreamSegmentPart(segment,
+      0, -1, [&](const uint8_t* bytes, size_t size, int64_t total_bytes) {
+        lock.lock();
+        // No data is passed while a resumed download waits for a retry.
+        if (size == 0) {
+          bool proceed = !d.aborted && report_progress();
+          lock.unlock();
+          return proceed;
+        }
+        if (d.parts == 1 && d.received[0] == 0 && total_bytes > 0) {
+          expected_size = total_bytes;
+          SplitDownload(download, total_bytes);
+        }
+        if (d.parts == 1) {
+          d.data->insert(d.data->end(), bytes, bytes + size);
+          d.received[0] += size;
+        } else {
+          uint64_t limit = d.fallback ? d.data->size() : d.part_size;
+          size = std::min<uint64_t>(size, limit - d.received[0]);
+          memcpy(d.data->data() + d.received[0], bytes, size);
+          d.received[0] += size;
+          // The first part stops once all other parts are known to come,
+          // otherwise it goes on.
+          while (d.received[0] == limit && !d.fallback && !d.aborted &&
+                 d.parts_started + 1 < d.parts) {
+            if (d.changed.wait_for(lock, kPartProgressInterval) ==
+                std::cv_status::timeout)
+              report_progress();
+          }
+          if (d.received[0] == limit && !d.fallback) {
+            first_part_done = true;
+            lock.unlock();
+            return false;
+          }
+        }
+        bool proceed = !d.aborted && report_progress();
+        lock.unlock();
+        return proceed;
+      });
+
+  lock.lock();
+  if (!completed && !first_part_done) {
+    d.aborted = true;
+    d.changed.notify_all();
+  }
+  while (d.parts_finished + 1 < d.parts) {
+    if (d.changed.wait_for(lock, kPartProgressInterval) ==
+        std::cv_status::timeout && !d.aborted)
+      report_progress();
+  }
+  if (d.aborted || IsCancelled(request))
+    return false;
+  if (d.parts == 1 || d.received[0] == d.data->size())
+    return completed;
+  size_t bytes_received = 0;
+  for (auto part_received : d.received)
+    bytes_received += part_received;
+  if (d.fallback || bytes_received != d.data->size()) {
+    LOG_ERROR("Failed to download a segment in %u parts.", d.parts);
+    return false;
+  }
+  return true;
+}
+
+void AsyncDataProvider::SplitDownload(
+    const std::shared_ptr<PartedDownload>& download, int64_t segment_size) {
+  auto& d = *download;
+  uint32_t parts = std::min<int64_t>(part_threads_.size() + 1,
+                                     segment_size / kMinPartSize);
+  if (parts < 2)
+    return;
+  LOG_DEBUG("Downloading a segment of %lld bytes in %u parts.",
+            static_cast<long long>(segment_size), parts);
+  d.parts = parts;
+  d.part_size = (segment_size + parts - 1) / parts;
+  d.received.assign(parts, 0);
+  d.data->resize(segment_size);
+  for (uint32_t part = 1; part < parts; ++part) {
+    part_threads_[part - 1]->message_loop().PostWork(cc_factory_.NewCallback(
+        &AsyncDataProvider::DownloadPartOnPartThread, download, part));
+  }
+}
+
+void AsyncDataProvider::DownloadPartOnPartThread(
+    int32_t, const std::shared_ptr<PartedDownload>& download, uint32_t part) {
+  auto& d = *download;
+  uint64_t offset = part * d.part_size;
+  uint64_t size = std::min<uint64_t>(d.part_size, d.data->size() - offset);
+  bool range_ignored = false;
+  bool started = false;
+  bool completed = StreamSegmentPart(d.segment, offset, size,
+      [&](const uint8_t* bytes, size_t length, int64_t) {
+        std::lock_guard<std::mutex> lock(d.mutex);
+        if (length == 0)
+          return !d.aborted;
+        if (!started) {
+          if (range_ignored) {
+            LOG_INFO("A server doesn't support byte ranges, a segment is "
+                     "downloaded over a single connection.");
+            d.fallback = true;
+            d.changed.notify_all();
+            return false;
+          }
+          started = true;
+          ++d.parts_started;
+          d.changed.notify_all();
+        }
+        if (d.aborted)
+          return false;
+        length = std::min<uint64_t>(length, size - d.received[part]);
+        memcpy(d.data->data() + offset + d.received[part], bytes, length);
+        d.received[part] += length;
+        return true;
+      }, &range_ignored);
+
+  std::lock_guard<std::mutex> lock(d.mutex);
+  if (!completed && !d.aborted)
+    d.fallback = true;
+  ++d.parts_finished;
+  d.changed.notify_all();
+}
+
 void AsyncDataProvider::PassResultOnCallerThread(int32_t,
-                                                 MediaSegment* segment) {
+                                                 MediaSegment* segment,
+                                                 uint32_t generation) {
   LOG_DEBUG("");
-  data_segment_callback_(AdoptUnique(segment));
+  auto result = AdoptUnique(segment);
+  // A request could be cancelled after its result was posted.
+  if (generation != request_generation_) {
+    LOG_DEBUG("Dropping a result of a cancelled request.");
+    return;
+  }
+  data_segment_callback_(std::move(result));
   LOG_DEBUG("Finishing");
 }
 
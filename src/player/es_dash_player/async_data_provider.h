@@ -20,7 +20,9 @@
 #ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ASYNC_DATA_PROVIDER_H_
 #define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_ASYNC_DATA_PROVIDER_H_
 
+#include <atomic>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -32,7 +34,10 @@
 
 #include "dash/media_segment_sequence.h"
 
+#include "bandwidth_estimator.h"
 #include "media_segment.h"
+#include "recent_segment_cache.h"
+#include "segment_buffer_pool.h"
 
 class AsyncDataProvider {
  public:
@@ -42,20 +47,73 @@ class AsyncDataProvider {
 
   ~AsyncDataProvider() {}
 
-  bool RequestNextDataSegment();
+  // Sets a number of connections over which providers created afterwards
+  // download large segments, each connection fetching a byte range of a
+  // segment. 1 (a default) downloads every segment over a single connection.
+  static void SetParallelConnections(uint32_t connections);
+
+  // Requests a next segment. If a deadline (in seconds from now) is given,
+  // the download is abandoned as soon as it's projected to finish after the
+  // deadline. An abandoned segment is passed to a callback with
+  // MediaSegment::abandoned_ set.
+  //
+  // A segment requested without a deadline can't be abandoned, so it's
+  // passed to a callback in chunks as it's downloaded (see
+  // MediaSegment::first_chunk_ and MediaSegment::last_chunk_).
+  bool RequestNextDataSegment(
+      double deadline = std::numeric_limits<double>::infinity());
+
+  // Makes a segment which starts at a given time the next one to be
+  // requested again, e.g. after its download was abandoned. A current
+  // sequence is used, so if the sequence was switched in the meantime, the
+  // segment is requested from the new representation.
+  void RewindToSegment(double timestamp, bool with_init_segment);
 
   bool SetNextSegmentToTime(double time);
 
+  // Cancels all segment requests made so far. A download in progress is
+  // closed as soon as possible and no data of cancelled requests is passed to
+  // a callback, so a next segment can be requested right away (e.g. after a
+  // seek).
+  void CancelPendingRequests();
+
   // Gets a time of a keyframe closest to a given time. The time must be
   // between 0 and clip duration.
   Samsung::NaClPlayer::TimeTicks GetClosestKeyframeTime(
       Samsung::NaClPlayer::TimeTicks);
 
+  // Gets a start time of a segment containing a given time. This only looks up
+  // the segment index and does not alter the next segment to download.
+  Samsung::NaClPlayer::TimeTicks GetSegmentStartTime(
+      Samsung::NaClPlayer::TimeTicks);
+
   void SetMediaSegmentSequence(std::unique_ptr<MediaSegmentSequence> sequence,
                                double time = 0.);
 
+  // Changes a sequence at a boundary of segments requested so far, i.e. the
+  // next requested segment will be the one that follows the last requested
+  // segment of a previous sequence. That segment is delivered along with an
+  // initialization segment of a new sequence (see MediaSegment::init_data_).
+  // A segment of a previous sequence which is being downloaded is delivered
+  // as usual.
+  void SwitchMediaSegmentSequence(
+      std::unique_ptr<MediaSegmentSequence> sequence);
+
   double AverageSegmentDuration();
 
+  // Tells which recently downloaded segments are most likely to be needed
+  // again and releases them, along with pooled segment buffers, if memory
+  // usage exceeds a budget. This should be called periodically during a
+  // playback.
+  void UpdatePlaybackPosition(Samsung::NaClPlayer::TimeTicks time);
+
+  // Sets an estimator which is given a size and a download time of every
+  // downloaded media segment. This must be called before a first segment is
+  // requested.
+  void SetBandwidthEstimator(std::shared_ptr<BandwidthEstimator> estimator) {
+    bandwidth_estimator_ = std::move(estimator);
+  }
+
   /// Needs to be called on non-main thread.
   bool GetInitSegment(std::vector<uint8_t>* buffer);
 
@@ -68,19 +126,82 @@ class AsyncDataProvider {
   }
 
  private:
+  struct SegmentRequest {
+    std::shared_ptr<MediaSegmentSequence> sequence;
+    MediaSegmentSequence::Iterator segment_iterator;
+    bool with_init_segment;
+    double deadline;
+    uint32_t generation;
+  };
+
+  bool IsCancelled(const SegmentRequest& request) const {
+    return request.generation != request_generation_;
+  }
+
+  // Sizes pooled segment buffers for a current sequence. Must be called with
+  // iterator_lock_ held.
+  void UpdateBufferSize();
+
   void DownloadNextSegmentOnOwnThread(
-      int32_t, MediaSegmentSequence::Iterator segment_iterator,
+      int32_t, const SegmentRequest& request,
       pp::MessageLoop destination_message_loop);
 
-  void PassResultOnCallerThread(int32_t, MediaSegment* segment);
+  // Downloads a segment, passing its data on in chunks. A given first chunk
+  // carries everything but data. Returns false if a download failed. cached
+  // is set if a segment was read from a cache. Whole data is gathered in
+  // segment_data, if given, so it can be cached once a download completes.
+  bool StreamSegmentOnOwnThread(const SegmentRequest& request,
+                                dash::mpd::ISegment* segment,
+                                std::unique_ptr<MediaSegment> chunk,
+                                pp::MessageLoop destination_message_loop,
+                                size_t* bytes_received, bool* cached,
+                                std::vector<uint8_t>* segment_data);
+
+  // A state of a segment download split into byte ranges.
+  struct PartedDownload;
+
+  // Downloads a segment, splitting it into byte ranges which are fetched in
+  // parallel on part_threads_ once a size of a segment is known (from a
+  // segment index or from a first response). Falls back to a single
+  // connection if a server doesn't support byte ranges.
+  bool DownloadInPartsOnOwnThread(const SegmentRequest& request,
+                                  dash::mpd::ISegment* segment,
+                                  int64_t segment_size,
+                                  std::vector<uint8_t>* data,
+                                  const DownloadProgressCallback& progress);
+
+  // Starts downloads of all parts but the first one, which is downloaded by
+  // a caller. Must be called with download->mutex locked.
+  void SplitDownload(const std::shared_ptr<PartedDownload>& download,
+                     int64_t segment_size);
+
+  void DownloadPartOnPartThread(int32_t,
+                                const std::shared_ptr<PartedDownload>& download,
+                                uint32_t part);
+
+  void PassResultOnCallerThread(int32_t, MediaSegment* segment,
+                                uint32_t generation);
 
   pp::SimpleThread own_thread_;
-  std::unique_ptr<MediaSegmentSequence> sequence_;
+  // Threads which download parts of a segment along with own_thread_.
+  std::vector<std::unique_ptr<pp::SimpleThread>> part_threads_;
+  // Shared with pending download tasks, so that a sequence outlives its
+  // segments being downloaded when it's changed.
+  std::shared_ptr<MediaSegmentSequence> sequence_;
   MediaSegmentSequence::Iterator next_segment_iterator_;
+  bool init_segment_pending_;
+  // Incremented whenever pending requests are cancelled.
+  std::atomic<uint32_t> request_generation_;
 
   pp::Lock iterator_lock_;
   pp::CompletionCallbackFactory<AsyncDataProvider> cc_factory_;
-  size_t last_segment_size_;
+  std::shared_ptr<BandwidthEstimator> bandwidth_estimator_;
+  // Segments are checked here before they are downloaded.
+  RecentSegmentCache recent_segments_;
+  // Buffers of segments downloaded whole are recycled through this pool.
+  // A buffer is shared by a segment and recent_segments_, and it's returned
+  // once both are done with it (see SegmentBufferPool::Share()).
+  std::shared_ptr<SegmentBufferPool> buffer_pool_;
   std::function<void(std::unique_ptr<MediaSegment>)> data_segment_callback_;
 };
 
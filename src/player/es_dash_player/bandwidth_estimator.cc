@@ -0,0 +1,145 @@
+/*!
+ * bandwidth_estimator.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bandwidth_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr size_t kMinSampleBytes = 16 * 1024;
+constexpr size_t kMinSamples = 2;
+constexpr size_t kWindowSize = 8;
+constexpr double kMinSampleSeconds = 0.001;
+constexpr double kFastHalfLife = 2.;   // in seconds
+constexpr double kSlowHalfLife = 8.;   // in seconds
+constexpr double kBitsPerByte = 8.;
+
+}  // anonymous namespace
+
+constexpr double BandwidthEstimator::kDefaultEstimate;
+
+BandwidthEstimator::Ewma::Ewma(double half_life)
+    : alpha_(std::exp(std::log(0.5) / half_life)),
+      estimate_(0.),
+      total_weight_(0.) {
+}
+
+void BandwidthEstimator::Ewma::AddSample(double weight, double value) {
+  double adjusted_alpha = std::pow(alpha_, weight);
+  estimate_ = value * (1. - adjusted_alpha) + adjusted_alpha * estimate_;
+  total_weight_ += weight;
+}
+
+double BandwidthEstimator::Ewma::GetEstimate() const {
+  // Estimate starts at 0, which biases it towards 0 until enough samples are
+  // gathered. This compensates for that bias.
+  double zero_factor = 1. - std::pow(alpha_, total_weight_);
+  return zero_factor > 0. ? estimate_ / zero_factor : 0.;
+}
+
+void BandwidthEstimator::Ewma::Reset() {
+  estimate_ = 0.;
+  total_weight_ = 0.;
+}
+
+BandwidthEstimator::BandwidthEstimator()
+    : window_bits_(0.),
+      window_seconds_(0.),
+      fast_average_(kFastHalfLife),
+      slow_average_(kSlowHalfLife),
+      sample_count_(0),
+      initial_estimate_(kDefaultEstimate) {
+}
+
+void BandwidthEstimator::AddSample(size_t bytes, double start_time,
+                                   double end_time, double media_seconds) {
+  double bits = bytes * kBitsPerByte;
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!window_.empty() && start_time < window_.back().end_time) {
+    // Downloads which overlap share a link, so each of them alone measures
+    // only a part of a throughput. They are merged into one sample and EWMAs
+    // are recomputed from a state they had before the first of them.
+    Sample& last = window_.back();
+    window_bits_ -= last.bits;
+    window_seconds_ -= last.seconds;
+    last.bits += bits;
+    last.start_time = std::min(last.start_time, start_time);
+    last.end_time = std::max(last.end_time, end_time);
+    last.seconds = std::max(last.end_time - last.start_time,
+                            kMinSampleSeconds);
+    last.media_seconds = std::max(last.media_seconds, media_seconds);
+    window_bits_ += last.bits;
+    window_seconds_ += last.seconds;
+    fast_average_ = last.fast_average_before;
+    slow_average_ = last.slow_average_before;
+    AddToAverages(last);
+    return;
+  }
+  if (bytes < kMinSampleBytes)
+    return;
+  double seconds = std::max(end_time - start_time, kMinSampleSeconds);
+  window_.push_back(Sample{bits, seconds, start_time, end_time, media_seconds,
+                           fast_average_, slow_average_});
+  window_bits_ += bits;
+  window_seconds_ += seconds;
+  if (window_.size() > kWindowSize) {
+    window_bits_ -= window_.front().bits;
+    window_seconds_ -= window_.front().seconds;
+    window_.pop_front();
+  }
+  AddToAverages(window_.back());
+  ++sample_count_;
+}
+
+void BandwidthEstimator::AddToAverages(const Sample& sample) {
+  double throughput = sample.bits / sample.seconds;
+  double weight = std::max(sample.seconds, sample.media_seconds);
+  fast_average_.AddSample(weight, throughput);
+  slow_average_.AddSample(weight, throughput);
+}
+
+double BandwidthEstimator::GetEstimate() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (sample_count_ < kMinSamples)
+    return initial_estimate_;
+  return std::min({window_bits_ / window_seconds_,
+                   fast_average_.GetEstimate(),
+                   slow_average_.GetEstimate()});
+}
+
+void BandwidthEstimator::SetInitialEstimate(double bits_per_second) {
+  std::lock_guard<std::mutex> lock(lock_);
+  initial_estimate_ = bits_per_second > 0. ? bits_per_second :
+                                             kDefaultEstimate;
+}
+
+bool BandwidthEstimator::HasEstimate() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return sample_count_ >= kMinSamples;
+}
+
+void BandwidthEstimator::Reset() {
+  std::lock_guard<std::mutex> lock(lock_);
+  window_.clear();
+  window_bits_ = 0.;
+  window_seconds_ = 0.;
+  fast_average_.Reset();
+  slow_average_.Reset();
+  sample_count_ = 0;
+}
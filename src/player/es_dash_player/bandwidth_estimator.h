@@ -0,0 +1,110 @@
+/*!
+ * bandwidth_estimator.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BANDWIDTH_ESTIMATOR_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BANDWIDTH_ESTIMATOR_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <mutex>
+
+// Estimates network throughput from segment download samples. Samples are
+// added by download threads, while estimates are usually read on a player
+// thread, so all methods are thread safe.
+//
+// An estimate is the lowest of:
+//  - a throughput over a sliding window of recent samples,
+//  - a fast EWMA, which reacts to throughput drops quickly,
+//  - a slow EWMA, which smooths out short bursts.
+// EWMAs are weighted by a time a sample stands for: a duration of media it
+// carries or a download time, whichever is longer. At a low bitrate on a fast
+// link downloads are short, so weighting by a download time alone would
+// keep an estimate low for minutes after a throughput recovers.
+//
+// Audio and video segments are downloaded at the same time, so each of them
+// gets only a share of a link. Downloads which overlap in time are merged
+// into one sample of all their bytes over their joint download time.
+class BandwidthEstimator {
+ public:
+  // An estimate used until enough samples are gathered, in bits per second.
+  static constexpr double kDefaultEstimate = 2000000.;
+
+  BandwidthEstimator();
+
+  // Adds a sample of a download of a given number of bytes which started and
+  // ended at given times, in seconds of any monotonic clock, and carried
+  // media_seconds of media (0 if unknown, e.g. for an abandoned download).
+  // Samples of small downloads are dominated by a request latency rather than
+  // by throughput, so they are ignored unless they overlap another download.
+  void AddSample(size_t bytes, double start_time, double end_time,
+                 double media_seconds);
+
+  // Returns an estimated throughput in bits per second, or an initial
+  // estimate if there are not enough samples yet.
+  double GetEstimate() const;
+
+  // Sets an estimate used until enough samples are gathered, e.g. one known
+  // from previous sessions (see BandwidthHistory). kDefaultEstimate is used
+  // if it isn't set.
+  void SetInitialEstimate(double bits_per_second);
+
+  bool HasEstimate() const;
+
+  void Reset();
+
+ private:
+  // Exponentially weighted moving average with a half-life given in seconds
+  // of sample weights.
+  class Ewma {
+   public:
+    explicit Ewma(double half_life);
+    void AddSample(double weight, double value);
+    double GetEstimate() const;
+    void Reset();
+
+   private:
+    double alpha_;
+    double estimate_;
+    double total_weight_;
+  };
+
+  struct Sample {
+    double bits;
+    double seconds;
+    double start_time;
+    double end_time;
+    double media_seconds;
+    // EWMAs as they were before this sample, so that a download which
+    // overlaps it can be merged into it.
+    Ewma fast_average_before;
+    Ewma slow_average_before;
+  };
+
+  void AddToAverages(const Sample& sample);
+
+  mutable std::mutex lock_;
+  std::deque<Sample> window_;
+  double window_bits_;
+  double window_seconds_;
+  Ewma fast_average_;
+  Ewma slow_average_;
+  size_t sample_count_;
+  double initial_estimate_;
+};
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BANDWIDTH_ESTIMATOR_H_
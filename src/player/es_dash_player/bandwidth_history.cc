@@ -0,0 +1,114 @@
+/*!
+ * bandwidth_history.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bandwidth_history.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "common.h"
+
+namespace {
+
+const char kHistoryFile[] = "/persistent/bandwidth_history";
+
+}  // anonymous namespace
+
+constexpr size_t BandwidthHistory::kMaxEstimates;
+
+BandwidthHistory::BandwidthHistory() = default;
+
+std::string BandwidthHistory::HostFromUrl(const std::string& url) {
+  auto scheme_end = url.find("://");
+  if (scheme_end == std::string::npos)
+    return std::string();
+  auto host_begin = scheme_end + 3;
+  auto host_end = url.find_first_of(":/?#", host_begin);
+  return url.substr(host_begin, host_end == std::string::npos ?
+                                    std::string::npos : host_end - host_begin);
+}
+
+bool BandwidthHistory::Load() {
+  if (!MountPersistentStorage())
+    return false;
+  std::ifstream file(kHistoryFile);
+  if (!file)
+    return false;
+
+  // Each line holds a host followed by its estimates, oldest first.
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string host;
+    if (!(fields >> host))
+      continue;
+    auto& estimates = estimates_[host];
+    double estimate;
+    while (fields >> estimate) {
+      if (estimate > 0.)
+        estimates.push_back(estimate);
+    }
+    while (estimates.size() > kMaxEstimates)
+      estimates.pop_front();
+  }
+  LOG_INFO("Loaded bandwidth history of %zu hosts.", estimates_.size());
+  return !estimates_.empty();
+}
+
+bool BandwidthHistory::Save() const {
+  if (!MountPersistentStorage())
+    return false;
+  std::ofstream file(kHistoryFile, std::ios::trunc);
+  if (!file) {
+    LOG_ERROR("Failed to open %s for writing.", kHistoryFile);
+    return false;
+  }
+  for (const auto& host : estimates_) {
+    file << host.first;
+    for (auto estimate : host.second)
+      file << ' ' << static_cast<uint64_t>(estimate);
+    file << '\n';
+  }
+  return static_cast<bool>(file);
+}
+
+double BandwidthHistory::Estimate(const std::string& host) const {
+  auto found = estimates_.find(host);
+  if (found == estimates_.end() || found->second.empty())
+    return 0.;
+  std::vector<double> estimates(found->second.begin(), found->second.end());
+  // A lower median, with an even number of estimates.
+  auto median = estimates.begin() + (estimates.size() - 1) / 2;
+  std::nth_element(estimates.begin(), median, estimates.end());
+  return *median;
+}
+
+void BandwidthHistory::Record(const std::string& host,
+                              double bits_per_second) {
+  if (host.empty() || bits_per_second <= 0.)
+    return;
+  auto& estimates = estimates_[host];
+  if (recorded_hosts_.insert(host).second || estimates.empty()) {
+    estimates.push_back(bits_per_second);
+    if (estimates.size() > kMaxEstimates)
+      estimates.pop_front();
+  } else {
+    estimates.back() = bits_per_second;
+  }
+}
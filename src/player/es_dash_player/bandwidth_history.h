@@ -0,0 +1,67 @@
+/*!
+ * bandwidth_history.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BANDWIDTH_HISTORY_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BANDWIDTH_HISTORY_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+
+// Keeps last bandwidth estimates of playback sessions per origin host in a
+// persistent storage, so a next session from the same host can choose a
+// start representation knowing what throughput to expect.
+//
+// Estimates are stored in a file on an html5fs mount of nacl_io. Accessing
+// html5fs blocks, so methods which do I/O must not be called on the main
+// thread.
+class BandwidthHistory {
+ public:
+  // A number of sessions remembered per host.
+  static constexpr size_t kMaxEstimates = 5;
+
+  BandwidthHistory();
+
+  // Returns a host part of a given URL, or an empty string if there is none
+  // (e.g. for a relative path).
+  static std::string HostFromUrl(const std::string& url);
+
+  // Loads estimates stored by previous sessions. Returns false if a storage
+  // isn't available or has no estimates yet.
+  bool Load();
+
+  // Stores estimates of all hosts. Returns false if a storage isn't
+  // available.
+  bool Save() const;
+
+  // Returns a median of estimates stored for a host, in bits per second, or
+  // 0 if none is known.
+  double Estimate(const std::string& host) const;
+
+  // Records an estimate of a current session for a host. A first call for a
+  // host adds an estimate, next ones update it, so a session is remembered
+  // once however often it's recorded.
+  void Record(const std::string& host, double bits_per_second);
+
+ private:
+  std::map<std::string, std::deque<double>> estimates_;
+  // Hosts which already have an estimate of a current session.
+  std::set<std::string> recorded_hosts_;
+};
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BANDWIDTH_HISTORY_H_
@@ -0,0 +1,102 @@
+/*!
+ * buffering_policy.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BUFFERING_POLICY_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BUFFERING_POLICY_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Decides when a stream requests a next media segment and when a segment
+// download is abandoned. This is kept apart from StreamManager and
+// AsyncDataProvider and free of NaCl dependencies, so the same logic can be
+// run by the host side simulator in tools/abr_simulator.
+
+// Segments are requested until at least this much is buffered ahead of a
+// playback position (or one average segment if segments are longer).
+constexpr double kNextSegmentTimeThreshold = 7.0;  // in seconds
+
+// Segments are downloaded regardless of a memory budget if less than this
+// is buffered, so a playback can progress and release memory.
+constexpr double kMinBufferedTime = 2.0;  // in seconds
+
+// A download isn't abandoned before this much of it passes, so a throughput
+// projection isn't dominated by a request latency.
+constexpr double kMinAbandonCheckTime = 0.5;  // in seconds
+
+// Checks if a stream which has buffered_ahead seconds of media segments
+// downloaded (or being downloaded) ahead of a playback position should
+// request a next segment.
+inline bool IsSegmentRequestDue(double buffered_ahead,
+                                double average_segment_duration,
+                                bool seeking, bool over_budget) {
+  auto next_segment_threshold =
+      std::max(kNextSegmentTimeThreshold, average_segment_duration);
+  if (buffered_ahead >= next_segment_threshold)
+    return false;
+  // Keep only a minimal buffer until memory is released by a playback.
+  return seeking || buffered_ahead < kMinBufferedTime || !over_budget;
+}
+
+// Returns a time in which a next segment must be downloaded, counting from
+// its request. A segment which can't be downloaded before buffered data runs
+// out is abandoned, so a lower representation can be tried instead of
+// stalling. Returns infinity if a download may take as long as it needs.
+inline double SegmentRequestDeadline(double buffered_ahead,
+                                     bool abandonment_enabled, bool seeking) {
+  if (abandonment_enabled && !seeking && buffered_ahead > 0.)
+    return buffered_ahead;
+  return std::numeric_limits<double>::infinity();
+}
+
+// Checks if a download which received bytes_received of total_bytes in
+// elapsed seconds is projected to miss a deadline, in which case it should be
+// abandoned. A projected download time is stored in projected, if given.
+inline bool IsDownloadLate(double elapsed, size_t bytes_received,
+                           int64_t total_bytes, double deadline,
+                           double* projected = nullptr) {
+  if (total_bytes <= 0 || elapsed < kMinAbandonCheckTime)
+    return false;
+  double rate = bytes_received / elapsed;
+  double projected_time = elapsed +
+      (static_cast<double>(total_bytes) - bytes_received) / rate;
+  if (projected)
+    *projected = projected_time;
+  return projected_time > deadline;
+}
+
+// One step of a segment request loop, run whenever stream buffers are
+// updated: a video representation is adapted right before a next video
+// segment is requested, then each stream requests a segment if it's due.
+// Returns true if any stream has more segments to download.
+template <typename Stream, typename Streams, typename AdaptVideo>
+bool UpdateStreamBuffers(double playback_time, const Stream& video,
+                         const Streams& streams, AdaptVideo adapt_video) {
+  if (video && video->IsSegmentRequestDue(playback_time))
+    adapt_video(playback_time);
+
+  bool segments_pending = false;
+  for (const auto& stream : streams) {
+    if (stream)
+      segments_pending |= stream->UpdateBuffer(playback_time);
+  }
+  return segments_pending;
+}
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_BUFFERING_POLICY_H_
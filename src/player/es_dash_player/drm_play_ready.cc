@@ -24,7 +24,6 @@
 #include "ppapi/cpp/completion_callback.h"
 #include "ppapi/cpp/url_loader.h"
 #include "ppapi/cpp/url_response_info.h"
-#include "ppapi/cpp/url_request_info.h"
 
 #include "drm_play_ready.h"
 
@@ -38,7 +37,6 @@ using std::vector;
 using pp::CompletionCallback;
 using pp::URLLoader;
 using pp::URLResponseInfo;
-using pp::URLRequestInfo;
 using Samsung::NaClPlayer::DRMOperation_InstallLicense;
 using Samsung::NaClPlayer::DRMType;
 using Samsung::NaClPlayer::DRMType_Playready;
@@ -91,15 +89,15 @@ void DrmPlayReadyListener::OnLicenseRequest(uint32_t request_size,
 
   ++pending_licence_requests_;
 
-  URLRequestInfo lic_request = GetRequestForURL(cp_descriptor_->system_url_);
-  lic_request.SetMethod("POST");
-  lic_request.AppendDataToBody(soap_request.data(), soap_request.size());
+  HttpRequest lic_request = GetRequestForURL(cp_descriptor_->system_url_);
+  lic_request.method = "POST";
+  lic_request.body.assign(soap_request.begin(), soap_request.end());
   if (!cp_descriptor_->key_request_properties_.empty()) {
     std::ostringstream oss;
     for (const auto& e : cp_descriptor_->key_request_properties_)
       oss << e.first << ": " << e.second << "\n";
 
-    lic_request.SetHeaders(oss.str());
+    lic_request.headers = oss.str();
   }
 
   side_thread_loop_.PostWork(cc_factory_.NewCallback(
@@ -110,7 +108,7 @@ void DrmPlayReadyListener::OnLicenseRequest(uint32_t request_size,
 }
 
 void DrmPlayReadyListener::ProcessLicenseRequestOnSideThread(
-    int32_t, const std::string& url, URLRequestInfo lic_request) {
+    int32_t, const std::string& url, HttpRequest lic_request) {
   LOG_DEBUG("Start");
   std::string response;
   int32_t ret = ProcessURLRequestOnSideThread(lic_request, &response);
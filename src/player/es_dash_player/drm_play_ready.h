@@ -32,11 +32,11 @@
 #include "ppapi/cpp/message_loop.h"
 #include "ppapi/utility/completion_callback_factory.h"
 
+#include "common.h"
 #include "dash/content_protection_visitor.h"
 
 namespace pp {
 class MessageLoop;
-class URLRequestInfo;
 }
 
 namespace dash {
@@ -93,7 +93,7 @@ class DrmPlayReadyListener : public Samsung::NaClPlayer::DRMListener {
  private:
   void ProcessLicenseRequestOnSideThread(int32_t,
                                          const std::string& url,
-                                         pp::URLRequestInfo lic_request);
+                                         HttpRequest lic_request);
 
   pp::InstanceHandle instance_;
   pp::MessageLoop side_thread_loop_;
@@ -18,6 +18,7 @@
  * @author Michal Murgrabia
  */
 
+#include <algorithm>
 #include <functional>
 #include <limits>
 #include <utility>
@@ -33,6 +34,11 @@
 #include "dash/dash_manifest.h"
 #include "dash/util.h"
 
+#include "abr_controller.h"
+#include "bandwidth_estimator.h"
+#include "bandwidth_history.h"
+#include "buffering_policy.h"
+#include "resolution_cap.h"
 #include "drm_play_ready.h"
 
 using Samsung::NaClPlayer::DRMType;
@@ -57,6 +63,13 @@ const int64_t kMainLoopDelay = 50;  // in milliseconds
 
 namespace {
 
+// How often a bandwidth estimate of a session is stored.
+constexpr std::chrono::seconds kBandwidthRecordInterval{30};
+
+// Start and seek positions are kept this far before an end of media, so
+// they reliably fall within a last segment.
+constexpr TimeTicks kEndOfMediaMargin = 0.25;
+
 template<typename RepType>
 void PrintChosenRepresentation(const RepType& s);
 
@@ -82,7 +95,9 @@ class EsDashPlayerController::Impl {
                                const std::vector<RepType>& representations) {
     if (representations.empty()) return;
 
-    RepType s = GetHighestBitrateStream(representations);
+    RepType s = ChooseRepresentation(thiz, representations);
+    thiz->current_representations_[static_cast<size_t>(type)] =
+        s.description.id;
     thiz->message_sender_->SetRepresentations(representations);
     thiz->message_sender_->ChangeRepresentation(type, s.description.id);
     PrintChosenRepresentation(s);
@@ -124,8 +139,10 @@ class EsDashPlayerController::Impl {
         thiz->dash_parser_->GetSequence(
             static_cast<MediaStreamType>(type), s.description.id),
         thiz->data_source_.get(), configured_callback, es_packet_callback,
-        &thiz->packets_manager_, drm_type);
+        &thiz->packets_manager_, drm_type, thiz->start_time_);
+    stream_manager->SetBandwidthEstimator(thiz->bandwidth_estimator_);
     thiz->packets_manager_.SetStream(type, stream_manager.get());
+    UpdateSegmentAbandonment(thiz);
 
     if (s.description.content_protection) {
       auto play_ready_desc =
@@ -142,19 +159,179 @@ class EsDashPlayerController::Impl {
       thiz->state_ = PlayerState::kError;
     }
   }
+
+  static VideoStream ChooseRepresentation(EsDashPlayerController* thiz,
+      const std::vector<VideoStream>& representations) {
+    auto ladder = VideoLadder(representations);
+    thiz->video_abr_ = MakeUnique<AbrController>(
+        ladder, thiz->bandwidth_estimator_, thiz->abr_policy_);
+    thiz->video_abr_->SetResolutionCap(ResolutionCap(thiz, ladder));
+    if (thiz->abr_policy_ == AbrPolicyType::kModelPredictive)
+      LoadVideoSegmentIndexes(thiz, representations);
+    // Audio representation is always the highest one, see below.
+    if (!thiz->audio_representations_.empty()) {
+      thiz->video_abr_->SetReservedBandwidth(GetHighestBitrateStream(
+          thiz->audio_representations_).description.bitrate);
+    }
+    auto id = thiz->video_abr_->SelectInitialRepresentation();
+    for (const auto& representation : representations) {
+      if (representation.description.id == id)
+        return representation;
+    }
+    return GetHighestBitrateStream(representations);
+  }
+
+  static AudioStream ChooseRepresentation(EsDashPlayerController*,
+      const std::vector<AudioStream>& representations) {
+    return GetHighestBitrateStream(representations);
+  }
+
+  static std::vector<AbrRepresentation> VideoLadder(
+      const std::vector<VideoStream>& representations) {
+    std::vector<AbrRepresentation> ladder;
+    for (const auto& representation : representations) {
+      ladder.push_back({representation.description.id,
+                        representation.description.bitrate,
+                        representation.width, representation.height});
+    }
+    return ladder;
+  }
+
+  // Returns the highest resolution of a video representation worth fetching
+  // for a current view size, a display and a device class.
+  static VideoResolution ResolutionCap(const EsDashPlayerController* thiz,
+      const std::vector<AbrRepresentation>& ladder) {
+    VideoResolution view = {thiz->view_width_, thiz->view_height_};
+    VideoResolution display = {thiz->display_width_, thiz->display_height_};
+    return ComputeResolutionCap(ladder, view, display,
+                                MaxDecoderResolution(thiz->device_class_));
+  }
+
+  // Starts loading a segment index of every video representation in the
+  // background, so a policy can plan with actual sizes of upcoming segments.
+  // Until an index arrives, sizes of its representation are unknown and the
+  // policy estimates them from a bitrate.
+  static void LoadVideoSegmentIndexes(EsDashPlayerController* thiz,
+      const std::vector<VideoStream>& representations) {
+    LOG_INFO("Loading segment indexes of %zu video representations.",
+             representations.size());
+    thiz->video_index_sequences_.clear();
+    thiz->index_loading_cancelled_ = false;
+    thiz->index_thread_ = MakeUnique<pp::SimpleThread>(thiz->instance_);
+    thiz->index_thread_->Start();
+    auto player_loop = pp::MessageLoop::GetCurrent();
+    for (const auto& representation : representations) {
+      thiz->index_thread_->message_loop().PostWork(
+          thiz->cc_factory_.NewCallback(
+              &EsDashPlayerController::LoadVideoSegmentIndex,
+              representation.description.id, player_loop));
+    }
+    thiz->video_abr_->SetSegmentLookup([thiz](uint32_t id, double time,
+                                              size_t count) {
+      return UpcomingVideoSegments(thiz, id, time, count);
+    });
+  }
+
+  static std::vector<AbrSegment> UpcomingVideoSegments(
+      const EsDashPlayerController* thiz, uint32_t id, double time,
+      size_t count) {
+    std::vector<AbrSegment> segments;
+    const auto& sequences = thiz->video_index_sequences_;
+    auto found = sequences.find(id);
+    bool loaded = found != sequences.end() && found->second;
+    // Until an index of this representation is loaded, segments are timed
+    // as in any loaded one (representations are aligned) and their sizes are
+    // left unknown, so they're estimated from a bitrate.
+    if (!loaded) {
+      for (found = sequences.begin(); found != sequences.end(); ++found) {
+        if (found->second)
+          break;
+      }
+      if (found == sequences.end())
+        return segments;
+    }
+    const auto& sequence = found->second;
+    for (auto it = sequence->MediaSegmentForTime(time + kSegmentMargin);
+         it != sequence->End() && segments.size() < count; ++it) {
+      segments.push_back({sequence->SegmentDuration(it),
+                          loaded ? sequence->SegmentSize(it) :
+                              MediaSegmentSequence::kUnknownSegmentSize});
+    }
+    return segments;
+  }
+
+  // Seeds a bandwidth estimate of a new session with estimates of previous
+  // sessions from the same host, so a start representation is chosen by
+  // what the network delivered recently, instead of a fixed default.
+  static void LoadBandwidthHistory(EsDashPlayerController* thiz,
+                                   const std::string& mpd_file_path) {
+    if (!thiz->bandwidth_history_) {
+      thiz->bandwidth_history_ = MakeUnique<BandwidthHistory>();
+      thiz->bandwidth_history_->Load();
+    }
+    thiz->media_host_ = BandwidthHistory::HostFromUrl(mpd_file_path);
+    thiz->last_bandwidth_record_ = std::chrono::steady_clock::now();
+    auto estimate = thiz->bandwidth_history_->Estimate(thiz->media_host_);
+    if (estimate > 0.) {
+      LOG_INFO("Bandwidth of previous sessions from %s: %.0f bps",
+               thiz->media_host_.c_str(), estimate);
+    }
+    thiz->bandwidth_estimator_->SetInitialEstimate(estimate);
+  }
+
+  static void RecordBandwidth(EsDashPlayerController* thiz) {
+    auto now = std::chrono::steady_clock::now();
+    if (!thiz->bandwidth_history_ ||
+        !thiz->bandwidth_estimator_->HasEstimate() ||
+        now - thiz->last_bandwidth_record_ < kBandwidthRecordInterval)
+      return;
+    thiz->last_bandwidth_record_ = now;
+    thiz->bandwidth_history_->Record(thiz->media_host_,
+                                     thiz->bandwidth_estimator_->GetEstimate());
+    thiz->bandwidth_history_->Save();
+  }
+
+  // Video segment downloads may be abandoned only if there is a lower
+  // representation to switch to. Audio always plays the highest one.
+  static void UpdateSegmentAbandonment(EsDashPlayerController* thiz) {
+    auto index = static_cast<size_t>(StreamType::Video);
+    const auto& video_stream = thiz->streams_[index];
+    if (!video_stream)
+      return;
+    video_stream->SetSegmentAbandonment(thiz->video_abr_ &&
+        !thiz->representation_pinned_[index] &&
+        thiz->video_abr_->HasLowerRepresentation(
+            thiz->current_representations_[index]));
+  }
 };
 
+EsDashPlayerController::~EsDashPlayerController() = default;
+
 void EsDashPlayerController::InitPlayer(const std::string& mpd_file_path,
     const std::string& subtitle,
     const std::string& encoding,
     const std::string& drm_license_url,
     const std::unordered_map<std::string, std::string>&
-        drm_key_request_properties) {
-  LOG_INFO("Loading media from : [%s]", mpd_file_path.c_str());
+        drm_key_request_properties,
+    TimeTicks start_time,
+    DeviceClass device_class,
+    AbrPolicyType abr_policy) {
+  LOG_INFO("Loading media from : [%s], start time: %f [s]",
+           mpd_file_path.c_str(), start_time);
   CleanPlayer();
 
+  MemoryGovernor::GetInstance().SetDeviceClass(device_class);
+  device_class_ = device_class;
+  start_time_ = start_time;
+  if (!bandwidth_estimator_)
+    bandwidth_estimator_ = make_shared<BandwidthEstimator>();
+  representation_pinned_.fill(false);
+  abr_policy_ = abr_policy;
   drm_license_url_ = drm_license_url;
   drm_key_request_properties_ = drm_key_request_properties;
+  // A player thread isn't running yet, later changes are posted to it.
+  view_width_ = static_cast<uint32_t>(std::max(view_rect_.width(), 0));
+  view_height_ = static_cast<uint32_t>(std::max(view_rect_.height(), 0));
   player_ = make_shared<MediaPlayer>();
   listeners_.player_listener =
       make_shared<MediaPlayerListener>(message_sender_);
@@ -205,6 +382,7 @@ void EsDashPlayerController::InitializeDash(int32_t,
     LOG_ERROR("Failed to load/parse MPD manifest file!");
     return;
   }
+  Impl::LoadBandwidthHistory(this, mpd_file_path);
 
   auto es_data_source = std::make_shared<ESDataSource>();
   TimeTicks duration = ParseDurationToSeconds(dash_parser_->GetDuration());
@@ -218,6 +396,12 @@ void EsDashPlayerController::InitializeDash(int32_t,
   }
   data_source_ = es_data_source;
   media_duration_ = duration;
+  if (duration != kInvalidDuration &&
+      start_time_ > media_duration_ - kEndOfMediaMargin) {
+    start_time_ = media_duration_ - kEndOfMediaMargin;
+  } else if (start_time_ < kEps) {
+    start_time_ = 0.;
+  }
   for (auto& stream : streams_)
     stream.reset();
   video_representations_ = dash_parser_->GetVideoStreams();
@@ -233,8 +417,23 @@ void EsDashPlayerController::InitializeStreams(int32_t) {
   // Currently only Playready is supported
   DRMType drm_type = DRMType_Playready;
 
+  const auto& video_stream = streams_[static_cast<int32_t>(StreamType::Video)];
+  const auto& audio_stream = streams_[static_cast<int32_t>(StreamType::Audio)];
+
   InitializeVideoStream(drm_type);
+  // Playback will start at a video keyframe, audio is aligned to it.
+  if (start_time_ > 0. && video_stream)
+    start_time_ = video_stream->GetSegmentStartTime(start_time_);
   InitializeAudioStream(drm_type);
+  if (start_time_ > 0. && !video_stream && audio_stream)
+    start_time_ = audio_stream->GetSegmentStartTime(start_time_);
+
+  if (start_time_ > 0.) {
+    LOG_INFO("Starting playback at %f [s]", start_time_);
+    // Drop packets until a keyframe at the start position, just like after a
+    // seek.
+    packets_manager_.PrepareForSeek(start_time_);
+  }
 }
 
 void EsDashPlayerController::InitializeVideoStream(
@@ -286,6 +485,9 @@ void EsDashPlayerController::CleanPlayer() {
   player_->SetSubtitleListener(nullptr);
   player_->SetBufferingListener(nullptr);
   player_->SetDRMListener(nullptr);
+  // Segment indexes are dropped before a player thread, which receives them.
+  index_loading_cancelled_ = true;
+  index_thread_.reset();
   player_thread_.reset();
   data_source_.reset();
   dash_parser_.reset();
@@ -296,6 +498,9 @@ void EsDashPlayerController::CleanPlayer() {
   for (auto& stream : streams_)
     stream.reset();
   state_ = PlayerState::kUnitialized;
+  start_time_ = 0.;
+  video_abr_.reset();
+  video_index_sequences_.clear();
   video_representations_.clear();
   audio_representations_.clear();
   LOG_INFO("Finished closing.");
@@ -312,11 +517,10 @@ void EsDashPlayerController::Seek(TimeTicks original_time) {
   }
   seeking_ = true;
   // Seeking very close to media_duration_ will most likely place us after
-  // last segment. kSegmentMargin is substracted  from media_duration_, which
-  // will pretty reliable place us within the segment.
-  constexpr Samsung::NaClPlayer::TimeTicks kSegmentMargin = 0.25;
-  if (original_time > media_duration_ - kSegmentMargin) {
-    original_time = media_duration_ - kSegmentMargin;
+  // last segment. kEndOfMediaMargin is substracted  from media_duration_,
+  // which will pretty reliable place us within the segment.
+  if (original_time > media_duration_ - kEndOfMediaMargin) {
+    original_time = media_duration_ - kEndOfMediaMargin;
   } else if (original_time < kEps) {
     original_time = 0.;
   }
@@ -345,6 +549,20 @@ void EsDashPlayerController::Seek(TimeTicks original_time) {
   }
 }
 
+void EsDashPlayerController::SeekToStartTime() {
+  LOG_INFO("Moving player to a start position %f [s]", start_time_);
+  seeking_ = true;
+  auto callback = WeakBind(&EsDashPlayerController::OnSeek,
+      std::static_pointer_cast<EsDashPlayerController>(
+          shared_from_this()), _1);
+
+  int32_t ret = player_->Seek(start_time_, callback);
+  if (ret < ErrorCodes::CompletionPending) {
+    LOG_ERROR("Seek call failed, code: %d", ret);
+    seeking_ = false;
+  }
+}
+
 void EsDashPlayerController::OnSeek(int32_t ret) {
   if (ret == PP_OK) {
     seeking_ = false;
@@ -368,11 +586,98 @@ void EsDashPlayerController::ChangeRepresentation(StreamType stream_type,
                                                   int32_t id) {
   LOG_INFO("Changing rep type: %d -> %d", stream_type, id);
   player_thread_->message_loop().PostWork(cc_factory_.NewCallback(
-      &EsDashPlayerController::OnChangeRepresentation, stream_type, id));
+      &EsDashPlayerController::OnRepresentationRequest, stream_type, id));
+}
+
+void EsDashPlayerController::OnRepresentationRequest(int32_t,
+                                                     StreamType type,
+                                                     int32_t id) {
+  auto& pinned = representation_pinned_[static_cast<size_t>(type)];
+  if (id < 0) {
+    LOG_INFO("Representation of stream %d is selected automatically.", type);
+    pinned = false;
+    Impl::UpdateSegmentAbandonment(this);
+    return;
+  }
+  pinned = true;
+  OnChangeRepresentation(PP_OK, type, id);
+}
+
+void EsDashPlayerController::AdaptVideoRepresentation(
+    TimeTicks playback_time) {
+  auto index = static_cast<size_t>(StreamType::Video);
+  if (!video_abr_ || representation_pinned_[index] || seeking_)
+    return;
+
+  const auto& video_stream = streams_[index];
+  auto buffer_level = video_stream->GetBufferLevel(playback_time);
+  auto current_id = current_representations_[index];
+  // A segment download abandoned in a current representation is requested
+  // again, so this must choose a lower one.
+  auto id = static_cast<int32_t>(video_stream->IsLastSegmentAbandoned() ?
+      video_abr_->SelectRepresentationAfterAbandonment(current_id,
+          playback_time, buffer_level) :
+      video_abr_->SelectRepresentation(current_id, playback_time,
+          buffer_level));
+  if (id == current_representations_[index])
+    return;
+
+  message_sender_->ChangeRepresentation(StreamType::Video, id);
+  OnChangeRepresentation(PP_OK, StreamType::Video, id);
+}
+
+void EsDashPlayerController::SetDisplayResolution(uint32_t width,
+                                                  uint32_t height) {
+  display_width_ = width;
+  display_height_ = height;
+}
+
+void EsDashPlayerController::UpdateResolutionCap(int32_t,
+    uint32_t view_width, uint32_t view_height) {
+  view_width_ = view_width;
+  view_height_ = view_height;
+  if (!video_abr_)
+    return;
+
+  auto ladder = Impl::VideoLadder(video_representations_);
+  if (!video_abr_->SetResolutionCap(Impl::ResolutionCap(this, ladder)))
+    return;
+  Impl::UpdateSegmentAbandonment(this);
+
+  // Leave a representation above a new cap right away. If the cap was
+  // raised, higher representations are considered with a next segment.
+  auto index = static_cast<size_t>(StreamType::Video);
+  if (!streams_[index] ||
+      video_abr_->IsEligible(current_representations_[index]))
+    return;
+  TimeTicks playback_time = start_time_;
+  if (static_cast<int>(state_) > static_cast<int>(PlayerState::kReady))
+    player_->GetCurrentTime(playback_time);
+  AdaptVideoRepresentation(playback_time);
+}
+
+void EsDashPlayerController::LoadVideoSegmentIndex(int32_t, uint32_t id,
+    pp::MessageLoop destination) {
+  if (index_loading_cancelled_)
+    return;
+  auto sequence = dash_parser_->GetSequence(MediaStreamType::Video, id);
+  destination.PostWork(cc_factory_.NewCallback(
+      &EsDashPlayerController::OnVideoSegmentIndexLoaded, id,
+      sequence.release()));
+}
+
+void EsDashPlayerController::OnVideoSegmentIndexLoaded(int32_t, uint32_t id,
+    MediaSegmentSequence* sequence) {
+  std::unique_ptr<MediaSegmentSequence> loaded(sequence);
+  if (index_loading_cancelled_ || !video_abr_)
+    return;
+  LOG_DEBUG("Segment index of a video representation %u loaded.", id);
+  video_index_sequences_[id] = std::move(loaded);
 }
 
 void EsDashPlayerController::OnChangeRepresentation(int32_t, StreamType type,
                                                      int32_t id) {
+  current_representations_[static_cast<size_t>(type)] = id;
   if (seeking_) {
     waiting_representation_changes_[static_cast<size_t>(type)]
         = MakeUnique<int32_t>(id);
@@ -386,6 +691,8 @@ void EsDashPlayerController::OnChangeRepresentation(int32_t, StreamType type,
       streams_[static_cast<int32_t>(type)];
   stream_manager->SetMediaSegmentSequence(
       dash_parser_->GetSequence(static_cast<MediaStreamType>(type), id));
+  if (type == StreamType::Video)
+    Impl::UpdateSegmentAbandonment(this);
 }
 
 void EsDashPlayerController::UpdateStreamsBuffer(int32_t) {
@@ -399,22 +706,30 @@ void EsDashPlayerController::UpdateStreamsBuffer(int32_t) {
   if (static_cast<int>(state_) > static_cast<int>(PlayerState::kReady)) {
     player_->GetCurrentTime(current_playback_time);
   } else {
-    current_playback_time = 0.;
+    current_playback_time = start_time_;
   }
   LOG_DEBUG("Current time: %f [s]", current_playback_time);
+  MemoryGovernor::GetInstance().ReportUsage();
+  Impl::RecordBandwidth(this);
 
-  bool segments_pending = false;
-
-  for (const auto& stream : streams_) {
-    if (stream) {
-        segments_pending |= stream->UpdateBuffer(current_playback_time);
-    }
-  }
+  const auto& video_stream = streams_[static_cast<int32_t>(StreamType::Video)];
+  bool segments_pending = UpdateStreamBuffers(current_playback_time,
+      video_stream, streams_, [this](TimeTicks playback_time) {
+        AdaptVideoRepresentation(playback_time);
+      });
 
   if (static_cast<int>(state_) >= static_cast<int>(PlayerState::kReady) &&
       (!drm_listener_ || drm_listener_->IsInitialized())) {
-    bool has_buffered_packets = packets_manager_.UpdateBuffer(
-        current_playback_time);
+    bool has_buffered_packets = false;
+    bool start_pending = false;
+    for (const auto& stream : streams_)
+      start_pending |= stream && stream->IsStartPositionPending();
+    // Packets from a start position can't be appended before NaCl Player
+    // moves there.
+    if (!start_pending) {
+      has_buffered_packets = packets_manager_.UpdateBuffer(
+          current_playback_time);
+    }
 
     // All streams reached EOS:
     if (!waiting_seek_ && !segments_pending && !has_buffered_packets &&
@@ -441,6 +756,14 @@ void EsDashPlayerController::SetViewRect(const Rect& view_rect) {
   view_rect_ = view_rect;
   if (!player_) return;
 
+  // A view size is passed on, as view_rect_ belongs to this thread.
+  if (player_thread_) {
+    player_thread_->message_loop().PostWork(cc_factory_.NewCallback(
+        &EsDashPlayerController::UpdateResolutionCap,
+        static_cast<uint32_t>(std::max(view_rect_.width(), 0)),
+        static_cast<uint32_t>(std::max(view_rect_.height(), 0))));
+  }
+
   LOG_DEBUG("Set view rect to %d, %d", view_rect_.width(), view_rect_.height());
   auto callback = WeakBind(&EsDashPlayerController::OnSetDisplayRect,
       std::static_pointer_cast<EsDashPlayerController>(
@@ -509,6 +832,8 @@ void EsDashPlayerController::FinishStreamConfiguration() {
     if (state_ == PlayerState::kUnitialized)
       state_ = PlayerState::kReady;
     LOG_INFO("Data Source attached");
+    if (start_time_ > 0.)
+      SeekToStartTime();
   } else {
     state_ = PlayerState::kError;
     LOG_ERROR("Failed to AttachDataSource!");
@@ -20,14 +20,42 @@
 #ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_MEDIA_SEGMENT_H_
 #define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_MEDIA_SEGMENT_H_
 
+#include <memory>
 #include <vector>
 
+#include "memory_governor.h"
+
 struct MediaSegment {
-  std::vector<uint8_t> data_;
+  // Shared with RecentSegmentCache, so a segment which is kept in memory
+  // isn't copied. A buffer acquired from SegmentBufferPool goes back to it
+  // once the last reference is dropped (see SegmentBufferPool::Share()).
+  std::shared_ptr<const std::vector<uint8_t>> data_;
+  // An initialization segment of a representation that starts with this
+  // segment. It's empty unless this is the first segment downloaded after a
+  // representation change.
+  std::vector<uint8_t> init_data_;
   double duration_;
   double timestamp_;
+  // Set if a download was abandoned because it wouldn't finish before a
+  // buffer drains. Such a segment carries no data and has to be requested
+  // again (see AsyncDataProvider::RewindToSegment()).
+  bool abandoned_;
+  // Set if init_data_ was requested along with this segment.
+  bool with_init_segment_;
+  // A segment may be delivered in chunks as it's downloaded. A first chunk
+  // carries init_data_, a last one completes the segment. Both are set for a
+  // segment delivered whole.
+  bool first_chunk_;
+  bool last_chunk_;
+  // Registers data_ and init_data_ with MemoryGovernor.
+  MemoryAccount memory_account_;
 
-  MediaSegment() : data_(), duration_(0.0), timestamp_(0.0) {}
+  MediaSegment()
+      : data_(std::make_shared<std::vector<uint8_t>>()), init_data_(),
+        duration_(0.0), timestamp_(0.0),
+        abandoned_(false), with_init_segment_(false),
+        first_chunk_(true), last_chunk_(true),
+        memory_account_(MemoryGovernor::kSegmentData) {}
 };
 
 #endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_MEDIA_SEGMENT_H_
@@ -21,6 +21,8 @@
 
 #include <limits>
 
+#include "memory_governor.h"
+
 using Samsung::NaClPlayer::TimeTicks;
 
 namespace {
@@ -38,7 +40,10 @@ class BufferedPacket : public PacketsManager::BufferedStreamObject {
   BufferedPacket(StreamType type,
                  std::unique_ptr<ElementaryStreamPacket> packet)
       : BufferedStreamObject(type, packet->GetDts()),
-        packet_(std::move(packet)) {}
+        packet_(std::move(packet)),
+        memory_account_(MemoryGovernor::kPacketQueue) {
+    memory_account_.Set(packet_->GetDataSize());
+  }
   ~BufferedPacket() override = default;
   bool Append(StreamManager* stream_manager) override {
     LOG_DEBUG("demux_id: %d manager: %p dts: %f pts: %f dur: %f pts_end: %f"
@@ -56,6 +61,7 @@ class BufferedPacket : public PacketsManager::BufferedStreamObject {
   }
  private:
    std::unique_ptr<ElementaryStreamPacket> packet_;
+   MemoryAccount memory_account_;
 };
 
 template <typename ConfigT, StreamType stream_type>
@@ -90,7 +96,6 @@ PacketsManager::BufferedStreamObject::~BufferedStreamObject() = default;
 PacketsManager::PacketsManager()
     : seeking_(false),
       eos_count_(0),
-      seek_segment_set_{ {false, false} },
       seek_segment_video_time_(0),
       buffered_packets_timestamp_{ {0, 0} } {
 }
@@ -119,9 +124,10 @@ void PacketsManager::PrepareForSeek(Samsung::NaClPlayer::TimeTicks to_time) {
   // If streamManager sends packet, it means stream is at a new position. This
   // manager seek ends when it receives a keyframe packet for each stream.
   seeking_ = true;
-  seek_segment_set_[kAudioStreamId] = false;
-  seek_segment_set_[kVideoStreamId] = false;
-  seek_segment_video_time_ = 0;
+  // Determine a video keyframe the seek will land on up front, so that audio
+  // doesn't have to wait for video to resolve its segment in OnSeekData().
+  seek_segment_video_time_ = streams_[kVideoStreamId] ?
+      streams_[kVideoStreamId]->GetSegmentStartTime(to_time) : to_time;
   eos_count_ = 0;
   buffered_packets_timestamp_[kAudioStreamId] = 0;
   buffered_packets_timestamp_[kVideoStreamId] = 0;
@@ -194,43 +200,26 @@ void PacketsManager::OnEnoughData(StreamType type) {
 
 void PacketsManager::OnSeekData(StreamType type,
                                 TimeTicks new_time) {
-  if (streams_[kAudioStreamId] && type == StreamType::Audio) {
-    seek_segment_set_[kAudioStreamId] = true;
-  } else if (streams_[kVideoStreamId] && type == StreamType::Video) {
-    // If video track is present, we want to align seek to video keyframe
-    // (which is at the beginning start of a segment).
-    seek_segment_set_[kVideoStreamId] = true;
-    TimeTicks video_segment_start;
-    TimeTicks video_segment_duration;
-    streams_[kVideoStreamId]->SetSegmentToTime(new_time,
-        &video_segment_start, &video_segment_duration);
-    seek_segment_video_time_ = video_segment_start;
-    LOG_DEBUG("Seek to video segment: %f [s] ... %f [s]", video_segment_start,
-        video_segment_start + video_segment_duration);
-  } else {
+  auto stream_index = static_cast<int32_t>(type);
+  if (!streams_[stream_index]) {
     LOG_ERROR("Received an OnSeekData event for a non-existing stream (%s).",
               type == StreamType::Video ? "VIDEO" : "AUDIO");
     return;
   }
 
-  // If there is no video track, then just continue with seeking audio.
-  // Otherwise allow seeking audio only after seeking video (i.e. when video
-  // seek time is determined).
-  auto video_segment_set = !streams_[kVideoStreamId] ||
-                           seek_segment_set_[kVideoStreamId];
-  auto audio_segment_set = seek_segment_set_[kAudioStreamId];
-  if (streams_[kAudioStreamId] && audio_segment_set && video_segment_set) {
-    // Align audio seek time to video seek time if video track is present.
-    auto seek_audio_to_time = streams_[kVideoStreamId] ?
-                               seek_segment_video_time_ : new_time;
-    TimeTicks audio_segment_start;
-    TimeTicks audio_segment_duration;
-    streams_[kAudioStreamId]->SetSegmentToTime(seek_audio_to_time,
-                                               &audio_segment_start,
-                                               &audio_segment_duration);
-    LOG_DEBUG("Seek to audio segment: %f [s] ... %f [s]", audio_segment_start,
-        audio_segment_start + audio_segment_duration);
-  }
+  // A video segment start was already determined in PrepareForSeek(), so
+  // each stream can pick its seek segment as soon as its own OnSeekData event
+  // arrives. If video track is present, audio is aligned to the video keyframe
+  // (which is at the beginning of a segment).
+  auto seek_to_time = (type == StreamType::Audio && streams_[kVideoStreamId]) ?
+                      seek_segment_video_time_ : new_time;
+  TimeTicks segment_start;
+  TimeTicks segment_duration;
+  streams_[stream_index]->SetSegmentToTime(seek_to_time, &segment_start,
+                                           &segment_duration);
+  LOG_DEBUG("Seek to %s segment: %f [s] ... %f [s]",
+      type == StreamType::Video ? "video" : "audio", segment_start,
+      segment_start + segment_duration);
 }
 
 void PacketsManager::CheckSeekEndConditions(
@@ -0,0 +1,107 @@
+/*!
+ * recent_segment_cache.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "recent_segment_cache.h"
+
+#include <cmath>
+
+#include "common.h"
+
+using pp::AutoLock;
+
+namespace {
+
+// A part of a MemoryGovernor budget a cache of a single stream may take.
+constexpr size_t kBudgetDivisor = 8;
+
+}  // anonymous namespace
+
+RecentSegmentCache::RecentSegmentCache()
+    : size_(0),
+      playback_position_(0.),
+      memory_account_(MemoryGovernor::kSegmentCache) {}
+
+size_t RecentSegmentCache::Budget() const {
+  return MemoryGovernor::GetInstance().Budget() / kBudgetDivisor;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> RecentSegmentCache::Get(
+    const std::string& key) {
+  AutoLock lock(lock_);
+  auto found = entries_.find(key);
+  if (found == entries_.end())
+    return nullptr;
+  LOG_DEBUG("Recent segment cache hit: %s", key.c_str());
+  return found->second.data;
+}
+
+void RecentSegmentCache::Put(const std::string& key, double timestamp,
+    std::shared_ptr<const std::vector<uint8_t>> data) {
+  if (!data || data->empty() || data->size() > Budget())
+    return;
+  AutoLock lock(lock_);
+  if (entries_.count(key))
+    return;
+  Evict(data->size(), false);
+  size_ += data->size();
+  auto& entry = entries_[key];
+  entry.timestamp = timestamp;
+  entry.data = std::move(data);
+  memory_account_.Set(size_);
+}
+
+bool RecentSegmentCache::Fits(int64_t size) const {
+  size_t budget = Budget();
+  return budget > 0 && (size < 0 || static_cast<uint64_t>(size) <= budget);
+}
+
+void RecentSegmentCache::SetPlaybackPosition(double time) {
+  AutoLock lock(lock_);
+  playback_position_ = time;
+}
+
+void RecentSegmentCache::ReleaseUnderPressure() {
+  if (!MemoryGovernor::GetInstance().IsOverBudget())
+    return;
+  AutoLock lock(lock_);
+  Evict(0, true);
+}
+
+void RecentSegmentCache::Clear() {
+  AutoLock lock(lock_);
+  entries_.clear();
+  size_ = 0;
+  memory_account_.Set(0);
+}
+
+void RecentSegmentCache::Evict(size_t bytes_needed, bool under_pressure) {
+  auto& governor = MemoryGovernor::GetInstance();
+  size_t budget = Budget();
+  while (!entries_.empty() &&
+         (size_ + bytes_needed > budget ||
+          (under_pressure && governor.IsOverBudget()))) {
+    auto furthest = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (fabs(it->second.timestamp - playback_position_) >
+          fabs(furthest->second.timestamp - playback_position_))
+        furthest = it;
+    }
+    size_ -= furthest->second.data->size();
+    entries_.erase(furthest);
+    memory_account_.Set(size_);
+  }
+}
@@ -0,0 +1,86 @@
+/*!
+ * recent_segment_cache.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_RECENT_SEGMENT_CACHE_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_RECENT_SEGMENT_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ppapi/utility/threading/lock.h"
+
+#include "memory_governor.h"
+
+// Keeps recently downloaded segments of a stream in memory, so a short
+// back-seek or a switch back to a representation which was just left
+// doesn't download them again. Segments are keyed by a URL and a byte range,
+// so segments of all representations of a stream share one cache. Data is
+// shared with segments which are passed on, so it isn't copied; a buffer
+// from SegmentBufferPool goes back to the pool once it's evicted and parsed.
+//
+// The cache takes a part of a MemoryGovernor budget. When it's full, segments
+// furthest from a playback position are evicted first. Cached memory is
+// accounted as MemoryGovernor::kSegmentCache and it's released before
+// anything else when total usage exceeds a budget (see ReleaseUnderPressure).
+//
+// All methods are thread safe.
+class RecentSegmentCache {
+ public:
+  RecentSegmentCache();
+
+  // Returns cached data of a segment, or nullptr if a segment isn't cached.
+  std::shared_ptr<const std::vector<uint8_t>> Get(const std::string& key);
+
+  // Stores a segment which starts at a given time. Data isn't copied, the
+  // cache keeps a reference to it.
+  void Put(const std::string& key, double timestamp,
+           std::shared_ptr<const std::vector<uint8_t>> data);
+
+  // Checks if a segment of a given size (negative if unknown) can be stored,
+  // so it's worth gathering while it's streamed.
+  bool Fits(int64_t size) const;
+
+  void SetPlaybackPosition(double time);
+
+  // Evicts segments while MemoryGovernor reports usage over a budget.
+  void ReleaseUnderPressure();
+
+  void Clear();
+
+ private:
+  struct Entry {
+    double timestamp;
+    std::shared_ptr<const std::vector<uint8_t>> data;
+  };
+
+  size_t Budget() const;
+
+  // Evicts segments until a given number of bytes fits a budget, or while
+  // MemoryGovernor is over a budget if under_pressure is set. Must be called
+  // with lock_ held.
+  void Evict(size_t bytes_needed, bool under_pressure);
+
+  pp::Lock lock_;
+  std::map<std::string, Entry> entries_;
+  size_t size_;
+  double playback_position_;
+  MemoryAccount memory_account_;
+};
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_RECENT_SEGMENT_CACHE_H_
@@ -0,0 +1,84 @@
+/*!
+ * resolution_cap.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "resolution_cap.h"
+
+namespace {
+
+const VideoResolution kFullHd = {1920, 1080};
+const VideoResolution kUltraHd = {3840, 2160};
+
+uint32_t MinDimension(uint32_t a, uint32_t b) {
+  if (!a || !b)
+    return a ? a : b;
+  return a < b ? a : b;
+}
+
+VideoResolution MinResolution(const VideoResolution& a,
+                              const VideoResolution& b) {
+  return {MinDimension(a.width, b.width), MinDimension(a.height, b.height)};
+}
+
+}  // anonymous namespace
+
+VideoResolution MaxDecoderResolution(DeviceClass device_class) {
+  switch (device_class) {
+    case DeviceClass::kLowEnd:
+      return kFullHd;
+    case DeviceClass::kMidRange:
+    case DeviceClass::kHighEnd:
+    case DeviceClass::kUnknown:
+    default:
+      return kUltraHd;
+  }
+}
+
+bool FitsResolutionCap(const AbrRepresentation& representation,
+                       const VideoResolution& cap) {
+  return (!cap.width || representation.width <= cap.width) &&
+         (!cap.height || representation.height <= cap.height);
+}
+
+VideoResolution ComputeResolutionCap(
+    const std::vector<AbrRepresentation>& representations,
+    const VideoResolution& view, const VideoResolution& display,
+    const VideoResolution& decoder) {
+  auto limit = MinResolution(decoder, display);
+  auto wanted = MinResolution(limit, view);
+  if (!wanted.width || !wanted.height)
+    return limit;
+
+  // A representation scaled to fit in a view isn't upscaled if it is at
+  // least as wide or at least as high as the view.
+  const AbrRepresentation* lowest_covering = nullptr;
+  for (const auto& representation : representations) {
+    if (!representation.width || !representation.height ||
+        !FitsResolutionCap(representation, limit))
+      continue;
+    if (representation.width < wanted.width &&
+        representation.height < wanted.height)
+      continue;
+    if (!lowest_covering ||
+        static_cast<uint64_t>(representation.width) * representation.height <
+            static_cast<uint64_t>(lowest_covering->width) *
+                lowest_covering->height)
+      lowest_covering = &representation;
+  }
+  if (!lowest_covering)
+    return limit;
+  return {lowest_covering->width, lowest_covering->height};
+}
@@ -0,0 +1,60 @@
+/*!
+ * resolution_cap.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_RESOLUTION_CAP_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_RESOLUTION_CAP_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "memory_governor.h"
+
+#include "abr_policy.h"
+
+// A video resolution in pixels. A zero dimension is unknown or unlimited.
+struct VideoResolution {
+  uint32_t width;
+  uint32_t height;
+
+  bool operator==(const VideoResolution& other) const {
+    return width == other.width && height == other.height;
+  }
+  bool operator!=(const VideoResolution& other) const {
+    return !(*this == other);
+  }
+};
+
+// Returns the highest resolution a video decoder of a given device class
+// handles.
+VideoResolution MaxDecoderResolution(DeviceClass device_class);
+
+// Checks if a representation doesn't exceed a cap. Representations of an
+// unknown resolution always fit.
+bool FitsResolutionCap(const AbrRepresentation& representation,
+                       const VideoResolution& cap);
+
+// Returns the highest video resolution worth fetching. It is a resolution of
+// the lowest representation which isn't upscaled when displayed in a view
+// rect, so higher representations would only be scaled down. Display and
+// decoder resolutions are hard limits.
+VideoResolution ComputeResolutionCap(
+    const std::vector<AbrRepresentation>& representations,
+    const VideoResolution& view, const VideoResolution& display,
+    const VideoResolution& decoder);
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_RESOLUTION_CAP_H_
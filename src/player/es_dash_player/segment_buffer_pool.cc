@@ -0,0 +1,146 @@
+/*!
+ * segment_buffer_pool.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "segment_buffer_pool.h"
+
+#include <algorithm>
+
+#include "common.h"
+
+using pp::AutoLock;
+
+namespace {
+
+// One buffer is usually filled by a download while another one is parsed.
+constexpr size_t kMaxPooledBuffers = 2;
+
+constexpr std::chrono::seconds kReportInterval{10};
+
+constexpr double kMegabyte = 1024. * 1024.;
+
+}  // anonymous namespace
+
+SegmentBufferPool::SegmentBufferPool()
+    : buffer_size_(0),
+      memory_account_(MemoryGovernor::kSegmentBufferPool),
+      acquired_(0),
+      reused_(0),
+      allocated_(0),
+      regrown_(0),
+      discarded_(0),
+      returned_capacity_(0),
+      returned_size_(0),
+      last_report_() {}
+
+void SegmentBufferPool::SetBufferSize(size_t bytes) {
+  AutoLock lock(lock_);
+  buffer_size_ = bytes;
+  auto too_small = std::remove_if(buffers_.begin(), buffers_.end(),
+      [bytes](const std::vector<uint8_t>& buffer) {
+        return buffer.capacity() < bytes;
+      });
+  discarded_ += buffers_.end() - too_small;
+  buffers_.erase(too_small, buffers_.end());
+  UpdateMemoryAccount();
+}
+
+std::vector<uint8_t> SegmentBufferPool::Acquire() {
+  AutoLock lock(lock_);
+  ++acquired_;
+  std::vector<uint8_t> buffer;
+  if (!buffers_.empty()) {
+    ++reused_;
+    buffer = std::move(buffers_.back());
+    buffers_.pop_back();
+    UpdateMemoryAccount();
+  } else {
+    ++allocated_;
+    buffer.reserve(buffer_size_);
+  }
+  return buffer;
+}
+
+void SegmentBufferPool::Release(std::vector<uint8_t> buffer) {
+  if (!buffer.capacity())
+    return;
+  AutoLock lock(lock_);
+  returned_capacity_ += buffer.capacity();
+  returned_size_ += buffer.size();
+  if (buffer.capacity() > buffer_size_) {
+    // A segment was larger than expected. Following buffers are allocated
+    // large enough for it, so downloads don't reallocate them again.
+    if (buffer_size_)
+      ++regrown_;
+    buffer_size_ = buffer.capacity();
+  }
+  if (buffer.capacity() < buffer_size_ ||
+      buffers_.size() >= kMaxPooledBuffers ||
+      MemoryGovernor::GetInstance().IsOverBudget()) {
+    ++discarded_;
+    return;
+  }
+  buffer.clear();
+  buffers_.push_back(std::move(buffer));
+  UpdateMemoryAccount();
+}
+
+std::shared_ptr<const std::vector<uint8_t>> SegmentBufferPool::Share(
+    std::vector<uint8_t> buffer) {
+  auto pool = shared_from_this();
+  return std::shared_ptr<const std::vector<uint8_t>>(
+      new std::vector<uint8_t>(std::move(buffer)),
+      [pool](std::vector<uint8_t>* shared) {
+        pool->Release(std::move(*shared));
+        delete shared;
+      });
+}
+
+void SegmentBufferPool::ReleaseUnderPressure() {
+  if (!MemoryGovernor::GetInstance().IsOverBudget())
+    return;
+  AutoLock lock(lock_);
+  if (buffers_.empty())
+    return;
+  LOG_DEBUG("Freeing %zu pooled segment buffers, memory usage is over "
+            "a budget.", buffers_.size());
+  discarded_ += buffers_.size();
+  buffers_.clear();
+  UpdateMemoryAccount();
+}
+
+void SegmentBufferPool::ReportStatistics() {
+  AutoLock lock(lock_);
+  auto now = std::chrono::steady_clock::now();
+  if (!acquired_ || now - last_report_ < kReportInterval)
+    return;
+  last_report_ = now;
+  double slack = returned_capacity_ ?
+      100. * (returned_capacity_ - returned_size_) / returned_capacity_ : 0.;
+  LOG_INFO("Segment buffers: %zu acquired, %.0f%% reused, %zu allocated, "
+           "%zu regrown, %zu discarded, %.0f%% unused capacity, "
+           "%zu pooled (%.1f MB), buffer size %.1f MB", acquired_,
+           100. * reused_ / acquired_, allocated_, regrown_, discarded_, slack,
+           buffers_.size(), memory_account_.bytes() / kMegabyte,
+           buffer_size_ / kMegabyte);
+}
+
+void SegmentBufferPool::UpdateMemoryAccount() {
+  size_t bytes = 0;
+  for (const auto& buffer : buffers_)
+    bytes += buffer.capacity();
+  memory_account_.Set(bytes);
+}
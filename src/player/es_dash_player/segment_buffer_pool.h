@@ -0,0 +1,96 @@
+/*!
+ * segment_buffer_pool.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_SEGMENT_BUFFER_POOL_H_
+#define NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_SEGMENT_BUFFER_POOL_H_
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "ppapi/utility/threading/lock.h"
+
+#include "memory_governor.h"
+
+// Recycles large buffers of media segments of a stream, so a multi-megabyte
+// buffer isn't allocated and freed for every downloaded segment. A buffer is
+// acquired before a segment is downloaded. Once downloaded, it's shared by a
+// segment and RecentSegmentCache (see Share), and it's returned when both of
+// them are done with it.
+//
+// Buffers are sized to the largest segment of a representation, so a
+// download doesn't have to grow a buffer. A size is taken from a segment
+// index if a representation has one, otherwise the pool learns it from
+// segments that were downloaded. Idle buffers are accounted as
+// MemoryGovernor::kSegmentBufferPool and they're freed when total usage
+// exceeds a budget (see ReleaseUnderPressure).
+//
+// All methods are thread safe. A pool must be owned by a std::shared_ptr.
+class SegmentBufferPool
+    : public std::enable_shared_from_this<SegmentBufferPool> {
+ public:
+  SegmentBufferPool();
+
+  // Sets a capacity of buffers handed out by the pool. Pooled buffers which
+  // are smaller are freed.
+  void SetBufferSize(size_t bytes);
+
+  // Returns an empty buffer, a pooled one if available.
+  std::vector<uint8_t> Acquire();
+
+  // Takes a buffer back for reuse.
+  void Release(std::vector<uint8_t> buffer);
+
+  // Makes a buffer read-only and shareable. It's released to the pool when
+  // the last reference to it is dropped.
+  std::shared_ptr<const std::vector<uint8_t>> Share(
+      std::vector<uint8_t> buffer);
+
+  // Frees pooled buffers if MemoryGovernor reports usage over a budget.
+  void ReleaseUnderPressure();
+
+  // Logs reuse and fragmentation statistics. A report is logged at most once
+  // every few seconds, so this can be called from a playback loop.
+  void ReportStatistics();
+
+ private:
+  // Must be called with lock_ held.
+  void UpdateMemoryAccount();
+
+  pp::Lock lock_;
+  std::vector<std::vector<uint8_t>> buffers_;
+  size_t buffer_size_;
+  MemoryAccount memory_account_;
+
+  // Statistics since a pool was created.
+  size_t acquired_;
+  size_t reused_;
+  size_t allocated_;
+  // Buffers which were returned larger than a size they were handed out
+  // with, i.e. a download had to reallocate them.
+  size_t regrown_;
+  // Buffers which were freed instead of pooled, because they were too small
+  // or the pool was full.
+  size_t discarded_;
+  // Capacity and size of returned buffers. A difference is memory wasted
+  // by oversized buffers.
+  size_t returned_capacity_;
+  size_t returned_size_;
+  std::chrono::steady_clock::time_point last_report_;
+};
+
+#endif  // NATIVE_PLAYER_SRC_PLAYER_ES_DASH_PLAYER_SEGMENT_BUFFER_POOL_H_
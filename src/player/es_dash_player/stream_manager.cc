@@ -21,19 +21,25 @@
 #include "player/es_dash_player/stream_manager.h"
 
 #include <stdlib.h>
+#include <cmath>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "ppapi/utility/threading/lock.h"
 
 #include "common.h"
 #include "demuxer/elementary_stream_packet.h"
+#include "memory_governor.h"
 #include "demuxer/stream_demuxer.h"
 
 #include "player/es_dash_player/es_dash_player_controller.h"
 #include "player/es_dash_player/stream_listener.h"
 
 #include "async_data_provider.h"
+#include "bandwidth_estimator.h"
+#include "buffering_policy.h"
 #include "media_segment.h"
 
 using pp::AutoLock;
@@ -59,7 +65,7 @@ using std::vector;
 
 namespace {
 
-const TimeTicks kNextSegmentTimeThreshold = 7.0f;    // in seconds
+const int kNoDemuxer = -1;
 
 // This class breaks circular shared pointer dependency between:
 //    StreamManager
@@ -104,6 +110,7 @@ class StreamManager::Impl :
                               es_packet_callback,
        StreamListener* stream_listener,
        Samsung::NaClPlayer::DRMType drm_type,
+       Samsung::NaClPlayer::TimeTicks start_time,
        std::shared_ptr<ElementaryStreamListener> listener);
 
   void SetMediaSegmentSequence(
@@ -111,10 +118,27 @@ class StreamManager::Impl :
 
   bool UpdateBuffer(Samsung::NaClPlayer::TimeTicks playback_time);
 
+  bool IsSegmentRequestDue(Samsung::NaClPlayer::TimeTicks playback_time) const;
+
+  Samsung::NaClPlayer::TimeTicks GetBufferLevel(
+      Samsung::NaClPlayer::TimeTicks playback_time) const {
+    return std::max(buffered_segments_time_ - playback_time, 0.);
+  }
+
+  void SetBandwidthEstimator(std::shared_ptr<BandwidthEstimator> estimator);
+
+  void SetSegmentAbandonment(bool enabled) {
+    segment_abandonment_ = enabled;
+  }
+
+  bool IsLastSegmentAbandoned() const { return segment_abandoned_; }
+
   bool IsInitialized() { return initialized_; }
 
   bool IsSeeking() const { return seeking_; }
 
+  bool IsStartPositionPending() const { return start_position_pending_; }
+
   void OnNeedData(int32_t bytes_max);
   void OnEnoughData();
   void OnSeekData(Samsung::NaClPlayer::TimeTicks new_position);
@@ -136,11 +160,22 @@ class StreamManager::Impl :
   Samsung::NaClPlayer::TimeTicks GetClosestKeyframeTime(
       Samsung::NaClPlayer::TimeTicks);
 
+  Samsung::NaClPlayer::TimeTicks GetSegmentStartTime(
+      Samsung::NaClPlayer::TimeTicks);
+
  private:
   bool InitParser(StreamDemuxer::InitMode init_mode);
   bool ParseInitSegment();
   void GotSegment(std::unique_ptr<MediaSegment> segment);
 
+  // Starts parsing a new representation with a new demuxer. A current demuxer
+  // is kept until it delivers all packets from segments it already got.
+  bool SwitchDemuxer(const MediaSegment& segment);
+  void OnEsPacket(int demuxer_generation, StreamDemuxer::Message message,
+                  unique_ptr<ElementaryStreamPacket> packet);
+  void FlushHeldDemuxerOutput();
+  void ReleaseRetiringDemuxer(int32_t);
+
   void OnAudioConfig(const AudioConfig& audio_config);
   void OnVideoConfig(const VideoConfig& video_config);
 
@@ -149,6 +184,28 @@ class StreamManager::Impl :
 
   std::unique_ptr<StreamDemuxer> demuxer_;
   std::unique_ptr<AsyncDataProvider> data_provider_;
+  std::shared_ptr<BandwidthEstimator> bandwidth_estimator_;
+
+  // A demuxer of a previous representation which still parses segments
+  // downloaded before a representation change.
+  std::unique_ptr<StreamDemuxer> retiring_demuxer_;
+  int demuxer_generation_;
+  int retiring_generation_;
+  bool demuxer_has_media_;
+
+  // Output of demuxer_ is held while retiring_demuxer_ delivers its packets,
+  // so a new configuration is queued after all packets of the previous one.
+  bool holding_demuxer_output_;
+  std::vector<std::function<void()>> held_demuxer_output_;
+
+  // A segment starting a representation (and its chunks which follow), which
+  // waits for a previous representation change to complete.
+  std::deque<std::unique_ptr<MediaSegment>> deferred_segments_;
+
+  // Last configurations passed to stream_listener_, a configuration is passed
+  // again only if codec parameters change.
+  std::unique_ptr<AudioConfig> reported_audio_config_;
+  std::unique_ptr<VideoConfig> reported_video_config_;
 
   pp::CompletionCallbackFactory<Impl> callback_factory_;
 
@@ -167,6 +224,11 @@ class StreamManager::Impl :
   bool seeking_;
   bool changing_representation_;
   bool segment_pending_;
+  bool start_position_pending_;
+  bool segment_abandonment_;
+  bool segment_abandoned_;
+  // Set while chunks of a segment which is being downloaded are parsed.
+  bool receiving_segment_;
 
   AudioConfig audio_config_;
   VideoConfig video_config_;
@@ -174,12 +236,18 @@ class StreamManager::Impl :
 
   Samsung::NaClPlayer::TimeTicks buffered_segments_time_;
   Samsung::NaClPlayer::TimeTicks need_time_;
+  Samsung::NaClPlayer::TimeTicks start_time_;
+  Samsung::NaClPlayer::TimeTicks received_segment_time_;
 };  // class StreamManager::Impl
 
 StreamManager::Impl::Impl(pp::InstanceHandle instance, StreamType type)
     : instance_handle_(instance),
       stream_type_(type),
       data_provider_(),
+      demuxer_generation_(kNoDemuxer),
+      retiring_generation_(kNoDemuxer),
+      demuxer_has_media_(false),
+      holding_demuxer_output_(false),
       callback_factory_(this),
       stream_listener_(nullptr),
       drm_initialized_(false),
@@ -189,9 +257,15 @@ StreamManager::Impl::Impl(pp::InstanceHandle instance, StreamType type)
       seeking_(false),
       changing_representation_(false),
       segment_pending_(false),
+      start_position_pending_(false),
+      segment_abandonment_(false),
+      segment_abandoned_(false),
+      receiving_segment_(false),
       drm_type_(Samsung::NaClPlayer::DRMType_Unknown),
       buffered_segments_time_(0.),
-      need_time_(0.) {}
+      need_time_(0.),
+      start_time_(0.),
+      received_segment_time_(0.) {}
 
 StreamManager::Impl::~Impl() {
   LOG_DEBUG("");
@@ -210,6 +284,15 @@ void StreamManager::Impl::OnEnoughData() {
 void StreamManager::Impl::OnSeekData(TimeTicks new_position) {
   LOG_INFO("Type: %s, new_position: %f",
       stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO", new_position);
+  if (start_position_pending_ &&
+      fabs(new_position - start_time_) < kSegmentMargin) {
+    // Player reached a position this stream was initialized at, so the
+    // demuxer and segments downloaded so far are valid.
+    LOG_INFO("Player reached a start position.");
+    start_position_pending_ = false;
+    init_seek_ = true;
+    return;
+  }
   if (!init_seek_) {
     init_seek_ = true;
     return;
@@ -217,6 +300,7 @@ void StreamManager::Impl::OnSeekData(TimeTicks new_position) {
   if (InitParser(changing_representation_
                  ? StreamDemuxer::kFullInitialization
                  : StreamDemuxer::kSkipInitCodecData)) {
+    changing_representation_ = false;
     ParseInitSegment();
     stream_listener_->OnSeekData(stream_type_, new_position);
   }
@@ -226,8 +310,20 @@ void StreamManager::Impl::PrepareForSeek(
     Samsung::NaClPlayer::TimeTicks new_position) {
   buffered_segments_time_ = 0.0;
   seeking_ = true;
+  start_position_pending_ = false;
   drm_initialized_ = false;
   demuxer_.reset();
+  retiring_demuxer_.reset();
+  retiring_generation_ = kNoDemuxer;
+  holding_demuxer_output_ = false;
+  held_demuxer_output_.clear();
+  receiving_segment_ = false;
+  deferred_segments_.clear();
+  // Segments requested before a seek are obsolete, so their downloads are
+  // cancelled and a segment for a new position can be requested at once.
+  if (data_provider_)
+    data_provider_->CancelPendingRequests();
+  segment_pending_ = false;
 }
 
 void StreamManager::Impl::SetSegmentToTime(Samsung::NaClPlayer::TimeTicks time,
@@ -273,6 +369,7 @@ bool StreamManager::Impl::Initialize(
                            es_packet_callback,
     StreamListener* stream_listener,
     DRMType drm_type,
+    TimeTicks start_time,
     std::shared_ptr<ElementaryStreamListener> listener) {
   LOG_DEBUG("");
   if (!stream_configured_callback) {
@@ -288,7 +385,18 @@ bool StreamManager::Impl::Initialize(
   };
   data_provider_ = MakeUnique<AsyncDataProvider>(
       instance_handle_, callback);
-  data_provider_->SetMediaSegmentSequence(std::move(segment_sequence));
+  data_provider_->SetBandwidthEstimator(bandwidth_estimator_);
+  data_provider_->SetMediaSegmentSequence(std::move(segment_sequence),
+                                          start_time);
+  if (start_time > 0.) {
+    start_time_ = data_provider_->CurrentSegmentTimestamp();
+    need_time_ = start_time_;
+    buffered_segments_time_ = start_time_;
+    start_position_pending_ = true;
+    LOG_INFO("%s stream starts at %f [s]",
+             stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO",
+             start_time_);
+  }
 
   int32_t result = ErrorCodes::BadArgument;
   // Add a stream to ESDataSource
@@ -319,6 +427,8 @@ bool StreamManager::Impl::Initialize(
     LOG_ERROR("Failed to initialize parser or config listeners");
     return false;
   }
+  if (start_position_pending_)
+    demuxer_->SetTimestamp(start_time_);
 
   return ParseInitSegment();
 }
@@ -342,7 +452,13 @@ bool StreamManager::Impl::InitParser(StreamDemuxer::InitMode init_mode) {
     LOG_ERROR("Failed to construct a FFMpegStreamParser");
   }
 
-  if (!demuxer_->Init(es_packet_callback_, pp::MessageLoop::GetCurrent()))
+  auto generation = ++demuxer_generation_;
+  demuxer_has_media_ = false;
+  auto es_packet_callback = [this, generation](StreamDemuxer::Message message,
+      unique_ptr<ElementaryStreamPacket> packet) {
+    OnEsPacket(generation, message, std::move(packet));
+  };
+  if (!demuxer_->Init(es_packet_callback, pp::MessageLoop::GetCurrent()))
     return false;
 
   bool ok = demuxer_->SetAudioConfigListener([this](const AudioConfig& config) {
@@ -385,6 +501,13 @@ Samsung::NaClPlayer::TimeTicks StreamManager::Impl::GetClosestKeyframeTime(
   return data_provider_->GetClosestKeyframeTime(time);
 }
 
+Samsung::NaClPlayer::TimeTicks StreamManager::Impl::GetSegmentStartTime(
+    Samsung::NaClPlayer::TimeTicks time) {
+  if (!data_provider_)
+    return time;
+  return data_provider_->GetSegmentStartTime(time);
+}
+
 bool StreamManager::Impl::UpdateBuffer(TimeTicks playback_time) {
   LOG_DEBUG("stream manager: %p, playback_time: %f, buffered time: %f", this,
             playback_time, buffered_segments_time_);
@@ -394,71 +517,209 @@ bool StreamManager::Impl::UpdateBuffer(TimeTicks playback_time) {
     return true;
   }
 
+  // Recently downloaded segments are released first when memory runs short.
+  data_provider_->UpdatePlaybackPosition(playback_time);
+
   // Check if we need to request next segment download.
-  if (!segment_pending_) {
-    auto next_segment_threshold = std::max(kNextSegmentTimeThreshold,
-        data_provider_->AverageSegmentDuration());
-    if (buffered_segments_time_ - playback_time < next_segment_threshold) {
-      LOG_INFO("Requesting next %s segment...",
-                stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO");
-      bool has_more_segments = data_provider_->RequestNextDataSegment();
-      if (has_more_segments) {
-        segment_pending_ = true;
-      } else {
-        LOG_DEBUG("There are no more segments to load");
-        return false;
-      }
+  if (IsSegmentRequestDue(playback_time)) {
+    LOG_INFO("Requesting next %s segment...",
+              stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO");
+    auto deadline = SegmentRequestDeadline(
+        buffered_segments_time_ - playback_time, segment_abandonment_,
+        seeking_);
+    bool has_more_segments = data_provider_->RequestNextDataSegment(deadline);
+    if (has_more_segments) {
+      segment_pending_ = true;
+      segment_abandoned_ = false;
+    } else {
+      LOG_DEBUG("There are no more segments to load");
+      return false;
     }
   }
 
   return true;
 }
 
+bool StreamManager::Impl::IsSegmentRequestDue(TimeTicks playback_time) const {
+  if (!elementary_stream_ || segment_pending_)
+    return false;
+
+  auto buffered_ahead = buffered_segments_time_ - playback_time;
+  auto average_segment_duration = data_provider_->AverageSegmentDuration();
+  bool over_budget = MemoryGovernor::GetInstance().IsOverBudget();
+  if (::IsSegmentRequestDue(buffered_ahead, average_segment_duration,
+                            seeking_, over_budget))
+    return true;
+
+  if (over_budget && ::IsSegmentRequestDue(buffered_ahead,
+                         average_segment_duration, seeking_, false)) {
+    LOG_DEBUG("Media memory is over budget, %s segment download delayed.",
+              stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO");
+  }
+  return false;
+}
+
+void StreamManager::Impl::SetBandwidthEstimator(
+    std::shared_ptr<BandwidthEstimator> estimator) {
+  bandwidth_estimator_ = std::move(estimator);
+  if (data_provider_)
+    data_provider_->SetBandwidthEstimator(bandwidth_estimator_);
+}
+
 void StreamManager::Impl::SetMediaSegmentSequence(
     std::unique_ptr<MediaSegmentSequence> segment_sequence) {
-  LOG_INFO("Setting new %s sequence to %f [s]",
+  LOG_INFO("Setting new %s sequence after %f [s]",
             stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO",
             buffered_segments_time_);
-  // TODO(p.balut): This is needed only for adjusting a demuxer timestamp in
-  //                GotSegment() and will be redundant after update to ffmpeg
-  //                2.6+.
+  // Segments requested so far are parsed as usual. A new demuxer is created
+  // when a first segment of the new sequence arrives (see GotSegment()).
   changing_representation_ = true;
-  // TODO(p.balut): Assuring we request next segment should be more reliable
-  //                than just using timestamps (i.e. use segment indices).
-  need_time_ = buffered_segments_time_ + kSegmentMargin;
-  demuxer_.reset();
-  drm_initialized_ = false;
-  LOG_INFO("Parser reset");
-  data_provider_->SetMediaSegmentSequence(std::move(segment_sequence),
-      buffered_segments_time_ + kSegmentMargin);
-  if (InitParser(StreamDemuxer::kFullInitialization)) ParseInitSegment();
+  data_provider_->SwitchMediaSegmentSequence(std::move(segment_sequence));
 
   LOG_DEBUG("SetMediaSegmentSequence changed segments in data provider");
 }
 
 void StreamManager::Impl::GotSegment(std::unique_ptr<MediaSegment> segment) {
-  if (!segment->data_.empty()) {
+  if (segment->abandoned_) {
+    segment_pending_ = false;
+    if (seeking_)
+      return;
+    LOG_INFO("%s segment %f [s] was abandoned, it will be requested again.",
+             stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO",
+             segment->timestamp_);
+    data_provider_->RewindToSegment(segment->timestamp_,
+                                    segment->with_init_segment_);
+    segment_abandoned_ = true;
+    return;
+  }
+  if (!segment->data_->empty()) {
     LOG_DEBUG("Got %s segment. duration: %f, data size: %d, timestamp: %f [s]",
         stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO",
-        segment->duration_, segment->data_.size(), segment->timestamp_);
+        segment->duration_, segment->data_->size(), segment->timestamp_);
   }
-  segment_pending_ = false;
-  if ((seeking_ || changing_representation_) &&
-      segment->timestamp_ - kEps <= need_time_ &&
-      need_time_ < segment->duration_ + segment->timestamp_) {
-    LOG_INFO("This segment finishes a seek for this stream.");
-    changing_representation_ = false;
-    seeking_ = false;
-    demuxer_->SetTimestamp(segment->timestamp_);
-  } else if (seeking_) {
-    LOG_INFO("This segment is out of bounds and will be dropped. Expected "
-             "time == %f [s]", need_time_);
+  if (!deferred_segments_.empty() ||
+      (segment->first_chunk_ && !seeking_ && !segment->init_data_.empty() &&
+       retiring_demuxer_)) {
+    if (segment->first_chunk_) {
+      LOG_INFO("Previous representation change is in progress, deferring a "
+               "segment: %f [s]", segment->timestamp_);
+    }
+    deferred_segments_.push_back(std::move(segment));
+    return;
+  }
+  // A request is complete once a whole segment is received.
+  if (segment->last_chunk_)
+    segment_pending_ = false;
+  if (!segment->first_chunk_) {
+    if (!receiving_segment_ ||
+        fabs(segment->timestamp_ - received_segment_time_) > kEps)
+      return;
+    if (segment->last_chunk_)
+      receiving_segment_ = false;
+    // An empty chunk only completes a segment, it's not an end of stream.
+    if (segment->data_->empty())
+      return;
+    demuxer_->Parse(*segment->data_);
     return;
   }
+  receiving_segment_ = false;
+  if (seeking_) {
+    if (segment->timestamp_ - kEps <= need_time_ &&
+        need_time_ < segment->duration_ + segment->timestamp_) {
+      LOG_INFO("This segment finishes a seek for this stream.");
+      seeking_ = false;
+      demuxer_->SetTimestamp(segment->timestamp_);
+    } else {
+      LOG_INFO("This segment is out of bounds and will be dropped. Expected "
+               "time == %f [s]", need_time_);
+      return;
+    }
+  } else if (!segment->init_data_.empty()) {
+    if (!SwitchDemuxer(*segment))
+      return;
+  }
 
   buffered_segments_time_ =
       static_cast<TimeTicks>(segment->duration_ + segment->timestamp_);
-  demuxer_->Parse(segment->data_);
+  receiving_segment_ = !segment->last_chunk_;
+  received_segment_time_ = segment->timestamp_;
+  if (!segment->data_->empty())
+    demuxer_has_media_ = true;
+  demuxer_->Parse(*segment->data_);
+}
+
+bool StreamManager::Impl::SwitchDemuxer(const MediaSegment& segment) {
+  LOG_INFO("%s representation changes at %f [s]",
+           stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO",
+           segment.timestamp_);
+  if (demuxer_ && demuxer_has_media_) {
+    retiring_demuxer_ = std::move(demuxer_);
+    retiring_generation_ = demuxer_generation_;
+    holding_demuxer_output_ = true;
+    // An end of stream is signalled once all packets are delivered.
+    retiring_demuxer_->Parse(vector<uint8_t>());
+  } else {
+    demuxer_.reset();
+  }
+  drm_initialized_ = false;
+  changing_representation_ = false;
+  if (!InitParser(StreamDemuxer::kFullInitialization)) {
+    LOG_ERROR("Failed to initialize parser for a new representation");
+    return false;
+  }
+  demuxer_->SetTimestamp(segment.timestamp_);
+  demuxer_->Parse(segment.init_data_);
+  return true;
+}
+
+void StreamManager::Impl::OnEsPacket(int demuxer_generation,
+    StreamDemuxer::Message message,
+    unique_ptr<ElementaryStreamPacket> packet) {
+  if (demuxer_generation == retiring_generation_) {
+    if (message == StreamDemuxer::kEndOfStream) {
+      LOG_INFO("%s demuxer of a previous representation finished.",
+               stream_type_ == StreamType::Video ? "VIDEO" : "AUDIO");
+      retiring_generation_ = kNoDemuxer;
+      FlushHeldDemuxerOutput();
+      // This is called by the retiring demuxer, so it can't be destroyed here.
+      pp::MessageLoop::GetCurrent().PostWork(callback_factory_.NewCallback(
+          &StreamManager::Impl::ReleaseRetiringDemuxer));
+      return;
+    }
+    es_packet_callback_(message, std::move(packet));
+    return;
+  }
+
+  if (demuxer_generation != demuxer_generation_) {
+    LOG_DEBUG("Dropping a packet from an obsolete demuxer.");
+    return;
+  }
+
+  if (holding_demuxer_output_) {
+    auto held_packet =
+        make_shared<unique_ptr<ElementaryStreamPacket>>(std::move(packet));
+    held_demuxer_output_.push_back([this, message, held_packet]() {
+      es_packet_callback_(message, std::move(*held_packet));
+    });
+    return;
+  }
+  es_packet_callback_(message, std::move(packet));
+}
+
+void StreamManager::Impl::FlushHeldDemuxerOutput() {
+  holding_demuxer_output_ = false;
+  std::vector<std::function<void()>> held_output;
+  held_output.swap(held_demuxer_output_);
+  for (const auto& output : held_output)
+    output();
+}
+
+void StreamManager::Impl::ReleaseRetiringDemuxer(int32_t) {
+  retiring_demuxer_.reset();
+  std::deque<unique_ptr<MediaSegment>> segments;
+  segments.swap(deferred_segments_);
+  for (auto& segment : segments)
+    GotSegment(std::move(segment));
 }
 
 bool StreamManager::Impl::SetConfig(const AudioConfig& audio_config) {
@@ -543,10 +804,32 @@ bool StreamManager::Impl::SetConfig(const VideoConfig& video_config) {
 }
 
 void StreamManager::Impl::OnAudioConfig(const AudioConfig& audio_config) {
+  if (holding_demuxer_output_) {
+    held_demuxer_output_.push_back([this, audio_config]() {
+      OnAudioConfig(audio_config);
+    });
+    return;
+  }
+  if (reported_audio_config_ && *reported_audio_config_ == audio_config) {
+    LOG_INFO("Audio codec parameters didn't change, skipping config.");
+    return;
+  }
+  reported_audio_config_ = MakeUnique<AudioConfig>(audio_config);
   stream_listener_->OnStreamConfig(audio_config);
 }
 
 void StreamManager::Impl::OnVideoConfig(const VideoConfig& video_config) {
+  if (holding_demuxer_output_) {
+    held_demuxer_output_.push_back([this, video_config]() {
+      OnVideoConfig(video_config);
+    });
+    return;
+  }
+  if (reported_video_config_ && *reported_video_config_ == video_config) {
+    LOG_INFO("Video codec parameters didn't change, skipping config.");
+    return;
+  }
+  reported_video_config_ = MakeUnique<VideoConfig>(video_config);
   stream_listener_->OnStreamConfig(video_config);
 }
 
@@ -595,6 +878,10 @@ bool StreamManager::IsSeeking() const {
   return pimpl_->IsSeeking();
 }
 
+bool StreamManager::IsStartPositionPending() const {
+  return pimpl_->IsStartPositionPending();
+}
+
 void StreamManager::PrepareForSeek(
     Samsung::NaClPlayer::TimeTicks new_position) {
   pimpl_->PrepareForSeek(new_position);
@@ -624,6 +911,11 @@ Samsung::NaClPlayer::TimeTicks StreamManager::GetClosestKeyframeTime(
   return pimpl_->GetClosestKeyframeTime(time);
 }
 
+Samsung::NaClPlayer::TimeTicks StreamManager::GetSegmentStartTime(
+    Samsung::NaClPlayer::TimeTicks time) {
+  return pimpl_->GetSegmentStartTime(time);
+}
+
 bool StreamManager::Initialize(
     unique_ptr<MediaSegmentSequence> segment_sequence,
     ESDataSource* es_data_source,
@@ -632,10 +924,11 @@ bool StreamManager::Initialize(
                        unique_ptr<ElementaryStreamPacket>)>
                            es_packet_callback,
     StreamListener* stream_listener,
-    DRMType drm_type) {
+    DRMType drm_type,
+    TimeTicks start_time) {
   return pimpl_->Initialize(std::move(segment_sequence), es_data_source,
                             stream_configured_callback, es_packet_callback,
-                            stream_listener, drm_type,
+                            stream_listener, drm_type, start_time,
                             std::make_shared<StreamListenerProxy>(this));
 }
 
@@ -648,6 +941,27 @@ bool StreamManager::UpdateBuffer(TimeTicks playback_time) {
   return pimpl_->UpdateBuffer(playback_time);
 }
 
+bool StreamManager::IsSegmentRequestDue(TimeTicks playback_time) const {
+  return pimpl_->IsSegmentRequestDue(playback_time);
+}
+
+TimeTicks StreamManager::GetBufferLevel(TimeTicks playback_time) const {
+  return pimpl_->GetBufferLevel(playback_time);
+}
+
+void StreamManager::SetBandwidthEstimator(
+    std::shared_ptr<BandwidthEstimator> estimator) {
+  pimpl_->SetBandwidthEstimator(std::move(estimator));
+}
+
+void StreamManager::SetSegmentAbandonment(bool enabled) {
+  pimpl_->SetSegmentAbandonment(enabled);
+}
+
+bool StreamManager::IsLastSegmentAbandoned() const {
+  return pimpl_->IsLastSegmentAbandoned();
+}
+
 void StreamManager::SetMediaSegmentSequence(
     std::unique_ptr<MediaSegmentSequence> segment_sequence) {
   pimpl_->SetMediaSegmentSequence(std::move(segment_sequence));
@@ -19,6 +19,8 @@
 
 #include "player/player_provider.h"
 
+#include <algorithm>
+
 #include "player/es_dash_player/es_dash_player_controller.h"
 #include "player/url_player/url_player_controller.h"
 #include "logger.h"
@@ -31,7 +33,9 @@ std::shared_ptr<PlayerController> PlayerProvider::CreatePlayer(
     const std::string& subtitle, const std::string& encoding,
     const std::string& drm_license_url,
     const std::unordered_map<std::string, std::string>&
-        drm_key_request_properties) {
+        drm_key_request_properties,
+    Samsung::NaClPlayer::TimeTicks start_time, DeviceClass device_class,
+    AbrPolicyType abr_policy, const Rect& display_rect) {
   switch (type) {
     case kUrl: {
       std::shared_ptr<UrlPlayerController> controller =
@@ -44,8 +48,12 @@ std::shared_ptr<PlayerController> PlayerProvider::CreatePlayer(
       std::shared_ptr<EsDashPlayerController> controller =
           std::make_shared<EsDashPlayerController>(instance_, message_sender_);
       controller->SetViewRect(view_rect);
+      controller->SetDisplayResolution(
+          static_cast<uint32_t>(std::max(display_rect.width(), 0)),
+          static_cast<uint32_t>(std::max(display_rect.height(), 0)));
       controller->InitPlayer(url, subtitle, encoding,
-                             drm_license_url, drm_key_request_properties);
+                             drm_license_url, drm_key_request_properties,
+                             start_time, device_class, abr_policy);
       return controller;
     }
     default:
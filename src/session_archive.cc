@@ -0,0 +1,329 @@
+/*!
+ * session_archive.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "session_archive.h"
+
+#include <strings.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "ppapi/c/pp_errors.h"
+
+namespace {
+
+using std::chrono::steady_clock;
+
+// An archive starts with kArchiveMagic and ends with a trailer: an offset
+// of an index, a number of its entries and kIndexMagic. Numbers are stored
+// in a host byte order.
+const char kArchiveMagic[8] = {'N', 'P', 'S', 'A', 'R', 'C', 'H', '2'};
+const char kIndexMagic[8] = {'N', 'P', 'S', 'I', 'N', 'D', 'X', '2'};
+constexpr long kTrailerSize =
+    sizeof(uint64_t) + sizeof(uint32_t) + sizeof(kIndexMagic);
+
+constexpr int32_t kHttpPartialContent = 206;
+constexpr int32_t kHttpNotFound = 404;
+// A size of pieces a replayed response is passed on in.
+constexpr size_t kReplayChunkSize = 64 * 1024;
+
+// Returns a value of a Range header of a request, e.g. "bytes=0-499", or an
+// empty string if a request has none.
+std::string RangeOfRequest(const HttpRequest& request) {
+  std::istringstream header_lines(request.headers);
+  std::string line;
+  while (std::getline(header_lines, line)) {
+    auto colon = line.find(':');
+    if (colon != strlen("range") ||
+        strncasecmp(line.c_str(), "range", colon) != 0)
+      continue;
+    auto first = line.find_first_not_of(' ', colon + 1);
+    auto last = line.find_last_not_of(" \r");
+    if (first == std::string::npos)
+      return std::string();
+    return line.substr(first, last - first + 1);
+  }
+  return std::string();
+}
+
+std::string KeyForRequest(const HttpRequest& request,
+                          const std::string& range) {
+  std::string key = request.method + " " + request.url;
+  if (!range.empty())
+    key += " " + range;
+  return key;
+}
+
+void MountStorageFor(const std::string& path) {
+  if (path.compare(0, strlen(kPersistentStoragePath),
+                   kPersistentStoragePath) == 0)
+    MountPersistentStorage();
+}
+
+double SecondsSince(steady_clock::time_point start) {
+  return std::chrono::duration<double>(steady_clock::now() - start).count();
+}
+
+void SleepUntil(steady_clock::time_point start, double seconds) {
+  double remaining = seconds - SecondsSince(start);
+  if (remaining > 0.)
+    usleep(static_cast<useconds_t>(remaining * 1e6));
+}
+
+template <typename T>
+bool WriteValue(FILE* file, const T& value) {
+  return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+template <typename T>
+bool ReadValue(FILE* file, T* value) {
+  return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+bool WriteEntry(FILE* file, const SessionArchiveEntry& entry) {
+  uint32_t key_size = entry.key.size();
+  return WriteValue(file, key_size) &&
+      fwrite(entry.key.data(), 1, key_size, file) == key_size &&
+      WriteValue(file, entry.status_code) && WriteValue(file, entry.result) &&
+      WriteValue(file, entry.offset) &&
+      WriteValue(file, entry.size) && WriteValue(file, entry.first_byte) &&
+      WriteValue(file, entry.total);
+}
+
+bool ReadEntry(FILE* file, SessionArchiveEntry* entry) {
+  uint32_t key_size;
+  if (!ReadValue(file, &key_size))
+    return false;
+  entry->key.resize(key_size);
+  return fread(&entry->key[0], 1, key_size, file) == key_size &&
+      ReadValue(file, &entry->status_code) &&
+      ReadValue(file, &entry->result) && ReadValue(file, &entry->offset) && ReadValue(file, &entry->size) &&
+      ReadValue(file, &entry->first_byte) && ReadValue(file, &entry->total);
+}
+
+}  // anonymous namespace
+
+RecordingTransport::RecordingTransport(std::shared_ptr<Transport> transport,
+                                       const std::string& path)
+    : transport_(std::move(transport)),
+      path_(path),
+      file_(nullptr),
+      failed_(false),
+      index_(),
+      data_end_(0) {}
+
+RecordingTransport::~RecordingTransport() {
+  if (file_)
+    fclose(file_);
+}
+
+int32_t RecordingTransport::Fetch(const HttpRequest& request,
+                                  const DownloadDataCallback& on_data,
+                                  HttpResponseInfo* response) {
+  auto start = steady_clock::now();
+  std::vector<uint8_t> body;
+  double first_byte = -1.;
+  int32_t result = transport_->Fetch(request,
+      [&](const uint8_t* data, size_t size, int64_t total_bytes) {
+        if (first_byte < 0.)
+          first_byte = SecondsSince(start);
+        body.insert(body.end(), data, data + size);
+        return on_data(data, size, total_bytes);
+      }, response);
+  // An aborted transfer isn't recorded, a replay serves a whole response
+  // and a caller aborts it again. A failed transfer is recorded with data
+  // received until then, so a replay fails at the same point and a request
+  // which resumes it finds its own response.
+  if (result == PP_ERROR_ABORTED)
+    return result;
+  double total = SecondsSince(start);
+  if (first_byte < 0.)
+    first_byte = total;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!failed_) {
+    Append(KeyForRequest(request, RangeOfRequest(request)),
+           response->status_code, result, body, first_byte, total);
+  }
+  return result;
+}
+
+bool RecordingTransport::Append(const std::string& key, int32_t status_code,
+                                int32_t result,
+                                const std::vector<uint8_t>& body,
+                                double first_byte, double total) {
+  if (!file_) {
+    MountStorageFor(path_);
+    file_ = fopen(path_.c_str(), "w+b");
+    if (!file_ || fwrite(kArchiveMagic, sizeof(kArchiveMagic), 1, file_) != 1) {
+      LOG_ERROR("Failed to create a session archive: %s", path_.c_str());
+      failed_ = true;
+      return false;
+    }
+    data_end_ = sizeof(kArchiveMagic);
+    LOG_INFO("Recording a session to %s", path_.c_str());
+  }
+
+  // A response overwrites a previous index, which is written again after it.
+  SessionArchiveEntry entry = {key, status_code, result, data_end_,
+                               body.size(), first_byte, total};
+  bool written = fseek(file_, data_end_, SEEK_SET) == 0 &&
+      fwrite(body.data(), 1, body.size(), file_) == body.size();
+  if (written) {
+    data_end_ += body.size();
+    index_.push_back(entry);
+    for (const auto& indexed : index_)
+      written = written && WriteEntry(file_, indexed);
+    uint32_t count = index_.size();
+    written = written && WriteValue(file_, data_end_) &&
+        WriteValue(file_, count) &&
+        fwrite(kIndexMagic, sizeof(kIndexMagic), 1, file_) == 1 &&
+        fflush(file_) == 0;
+  }
+  if (!written) {
+    LOG_ERROR("Failed to write a session archive: %s", path_.c_str());
+    failed_ = true;
+    return false;
+  }
+  LOG_DEBUG("Recorded %s: %zu bytes in %.3f [s], result: %d", key.c_str(),
+            body.size(), total, result);
+  return true;
+}
+
+ReplayTransport::ReplayTransport(const std::string& path, double time_scale)
+    : path_(path),
+      time_scale_(std::max(time_scale, 0.)),
+      file_(nullptr),
+      opened_(false) {}
+
+ReplayTransport::~ReplayTransport() {
+  if (file_)
+    fclose(file_);
+}
+
+bool ReplayTransport::Open() {
+  if (opened_)
+    return file_ != nullptr;
+  opened_ = true;
+  MountStorageFor(path_);
+  file_ = fopen(path_.c_str(), "rb");
+  char magic[sizeof(kArchiveMagic)];
+  uint64_t index_offset;
+  uint32_t count;
+  bool valid = file_ && fread(magic, sizeof(magic), 1, file_) == 1 &&
+      memcmp(magic, kArchiveMagic, sizeof(magic)) == 0 &&
+      fseek(file_, -kTrailerSize, SEEK_END) == 0 &&
+      ReadValue(file_, &index_offset) && ReadValue(file_, &count) &&
+      fread(magic, sizeof(magic), 1, file_) == 1 &&
+      memcmp(magic, kIndexMagic, sizeof(magic)) == 0 &&
+      fseek(file_, index_offset, SEEK_SET) == 0;
+  for (uint32_t i = 0; valid && i < count; ++i) {
+    SessionArchiveEntry entry;
+    valid = ReadEntry(file_, &entry);
+    if (valid)
+      entries_[entry.key].push_back(entry);
+  }
+  if (!valid) {
+    LOG_ERROR("Failed to read a session archive: %s", path_.c_str());
+    entries_.clear();
+    if (file_)
+      fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  LOG_INFO("Replaying %u responses from %s, time scale: %.2f", count,
+           path_.c_str(), time_scale_);
+  return true;
+}
+
+bool ReplayTransport::ReadResponse(const std::string& key,
+                                   SessionArchiveEntry* entry,
+                                   std::vector<uint8_t>* body) {
+  auto found = entries_.find(key);
+  if (found == entries_.end())
+    return false;
+  const auto& responses = found->second;
+  size_t served = served_[key]++;
+  *entry = responses[std::min(served, responses.size() - 1)];
+  body->resize(entry->size);
+  if (fseek(file_, entry->offset, SEEK_SET) != 0 ||
+      fread(body->data(), 1, body->size(), file_) != body->size()) {
+    LOG_ERROR("Failed to read a response to %s from a session archive",
+              key.c_str());
+    return false;
+  }
+  return true;
+}
+
+int32_t ReplayTransport::Fetch(const HttpRequest& request,
+                               const DownloadDataCallback& on_data,
+                               HttpResponseInfo* response) {
+  auto start = steady_clock::now();
+  std::string range = RangeOfRequest(request);
+  SessionArchiveEntry entry;
+  std::vector<uint8_t> body;
+  // Set if a range is cut from a whole resource.
+  bool whole = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool found = Open() &&
+        (ReadResponse(KeyForRequest(request, range), &entry, &body) ||
+         (!range.empty() &&
+          (whole = ReadResponse(KeyForRequest(request, std::string()),
+                                &entry, &body))));
+    // A range can't be cut from a resource whose transfer failed.
+    if (whole && entry.result != PP_OK)
+      found = false;
+    if (!found) {
+      LOG_ERROR("No recorded response to %s %s %s", request.method.c_str(),
+                request.url.c_str(), range.c_str());
+      response->status_code = kHttpNotFound;
+      return PP_ERROR_FILENOTFOUND;
+    }
+  }
+
+  uint64_t first = 0;
+  uint64_t end = body.size();
+  double first_byte = entry.first_byte;
+  double transfer = entry.total - entry.first_byte;
+  response->status_code = entry.status_code;
+  if (whole) {
+    uint64_t last;
+    if (ParseRangeHeader(request.headers, body.size(), &first, &last)) {
+      end = last + 1;
+      response->status_code = kHttpPartialContent;
+      transfer *= static_cast<double>(end - first) / body.size();
+    }
+  }
+
+  response->timing = TransferTiming();
+  SleepUntil(start, first_byte * time_scale_);
+  response->timing.first_byte = SecondsSince(start);
+  int64_t total_bytes = end - first;
+  for (uint64_t offset = first; offset < end; offset += kReplayChunkSize) {
+    uint64_t size = std::min<uint64_t>(kReplayChunkSize, end - offset);
+    // Data is spread evenly over a recorded transfer time.
+    double progress = static_cast<double>(offset + size - first) / total_bytes;
+    SleepUntil(start, (first_byte + transfer * progress) * time_scale_);
+    if (!on_data(body.data() + offset, size, total_bytes))
+      return PP_ERROR_ABORTED;
+  }
+  response->timing.total = SecondsSince(start);
+  return entry.result;
+}
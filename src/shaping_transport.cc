@@ -0,0 +1,260 @@
+/*!
+ * shaping_transport.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "shaping_transport.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+using std::chrono::steady_clock;
+
+// Data is delivered in pieces of at most this size, so a paced transfer
+// progresses smoothly.
+constexpr size_t kSliceSize = 16 * 1024;
+
+constexpr double kKilobit = 1000.;
+constexpr double kMegabit = 1000. * 1000.;
+
+struct Profile {
+  const char* name;
+  double bandwidth;
+  double round_trip_time;
+  double jitter;
+  uint64_t stall_interval;
+  double stall_duration;
+  double failure_probability;
+};
+
+const Profile kProfiles[] = {
+  {"2g", 250 * kKilobit, 0.8, 0.2, 0, 0., 0.},
+  {"3g", 1.6 * kMegabit, 0.3, 0.1, 0, 0., 0.},
+  {"lte", 12 * kMegabit, 0.07, 0.02, 0, 0., 0.},
+  {"dsl", 5 * kMegabit, 0.04, 0.005, 0, 0., 0.},
+  {"cable", 30 * kMegabit, 0.02, 0.005, 0, 0., 0.},
+  {"lossy-wifi", 8 * kMegabit, 0.05, 0.04, 2 * 1024 * 1024, 1.5, 0.02},
+};
+
+void SleepUntil(steady_clock::time_point time) {
+  auto now = steady_clock::now();
+  if (time > now) {
+    usleep(std::chrono::duration_cast<std::chrono::microseconds>(
+        time - now).count());
+  }
+}
+
+steady_clock::duration Seconds(double seconds) {
+  return std::chrono::duration_cast<steady_clock::duration>(
+      std::chrono::duration<double>(seconds));
+}
+
+}  // anonymous namespace
+
+ShapingTransport::ShapingTransport(std::shared_ptr<Transport> transport,
+                                   const NetworkConditions& conditions)
+    : transport_(std::move(transport)),
+      conditions_(conditions),
+      trace_(),
+      trace_start_(steady_clock::now()),
+      failures_(),
+      random_(),
+      link_free_() {}
+
+bool ShapingTransport::ConditionsForProfile(const std::string& profile,
+                                            NetworkConditions* conditions) {
+  for (const auto& entry : kProfiles) {
+    if (profile != entry.name)
+      continue;
+    conditions->bandwidth = entry.bandwidth;
+    conditions->round_trip_time = entry.round_trip_time;
+    conditions->jitter = entry.jitter;
+    conditions->stall_interval = entry.stall_interval;
+    conditions->stall_duration = entry.stall_duration;
+    conditions->failure_probability = entry.failure_probability;
+    return true;
+  }
+  return false;
+}
+
+bool ShapingTransport::ParseBandwidthTrace(
+    const std::string& text, std::vector<BandwidthTracePoint>* trace) {
+  std::string points = text;
+  std::replace(points.begin(), points.end(), ',', ' ');
+  std::istringstream stream(points);
+  std::vector<BandwidthTracePoint> parsed;
+  std::string point;
+  while (stream >> point) {
+    char* end = nullptr;
+    BandwidthTracePoint parsed_point;
+    parsed_point.time = strtod(point.c_str(), &end);
+    if (*end != ':')
+      return false;
+    const char* kbps = end + 1;
+    parsed_point.bandwidth = strtod(kbps, &end) * kKilobit;
+    if (end == kbps || *end != '\0' || parsed_point.bandwidth < 0.)
+      return false;
+    if (!parsed.empty() && parsed_point.time <= parsed.back().time)
+      return false;
+    parsed.push_back(parsed_point);
+  }
+  *trace = std::move(parsed);
+  return true;
+}
+
+void ShapingTransport::SetConditions(const NetworkConditions& conditions) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  conditions_ = conditions;
+}
+
+void ShapingTransport::SetBandwidthTrace(
+    std::vector<BandwidthTracePoint> trace) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  trace_ = std::move(trace);
+  trace_start_ = steady_clock::now();
+}
+
+void ShapingTransport::InjectFailure(const std::string& url_part,
+                                     uint64_t offset, int32_t error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  failures_.push_back({url_part, offset, error});
+}
+
+void ShapingTransport::SetRandomSeed(uint32_t seed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  random_.seed(seed);
+}
+
+bool ShapingTransport::TakeFailure(const std::string& url,
+                                   InjectedFailure* failure) {
+  auto found = std::find_if(failures_.begin(), failures_.end(),
+      [&url](const InjectedFailure& injected) {
+        return url.find(injected.url_part) != std::string::npos;
+      });
+  if (found == failures_.end())
+    return false;
+  *failure = *found;
+  failures_.erase(found);
+  return true;
+}
+
+double ShapingTransport::BandwidthAt(steady_clock::time_point time) const {
+  if (trace_.empty())
+    return conditions_.bandwidth;
+  double elapsed = std::chrono::duration<double>(time - trace_start_).count();
+  auto next = std::upper_bound(trace_.begin(), trace_.end(), elapsed,
+      [](double elapsed, const BandwidthTracePoint& point) {
+        return elapsed < point.time;
+      });
+  return next == trace_.begin() ? next->bandwidth : (next - 1)->bandwidth;
+}
+
+steady_clock::time_point ShapingTransport::ReserveLink(size_t bytes) {
+  auto now = steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  double bandwidth = BandwidthAt(now);
+  if (bandwidth <= 0.)
+    return now;
+  // Concurrent requests share a link, so each piece of data is sent after
+  // all data reserved before it.
+  link_free_ = std::max(link_free_, now) + Seconds(bytes * 8. / bandwidth);
+  return link_free_;
+}
+
+int32_t ShapingTransport::Fetch(const HttpRequest& request,
+                                const DownloadDataCallback& on_data,
+                                HttpResponseInfo* response) {
+  auto start = steady_clock::now();
+  NetworkConditions conditions;
+  double delay;
+  InjectedFailure failure;
+  bool fails;
+  bool fails_randomly = false;
+  double failure_position = 0.;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    conditions = conditions_;
+    delay = conditions.round_trip_time;
+    if (conditions.jitter > 0.) {
+      delay += std::uniform_real_distribution<double>(
+          -conditions.jitter, conditions.jitter)(random_);
+    }
+    fails = TakeFailure(request.url, &failure);
+    if (!fails && conditions.failure_probability > 0.) {
+      fails_randomly = std::bernoulli_distribution(
+          conditions.failure_probability)(random_);
+      failure_position =
+          std::uniform_real_distribution<double>(0., 1.)(random_);
+    }
+  }
+  SleepUntil(start + Seconds(std::max(delay, 0.)));
+
+  uint64_t delivered = 0;
+  uint64_t next_stall = conditions.stall_interval;
+  bool failed = false;
+  double first_byte = -1.;
+  int32_t result = transport_->Fetch(request,
+      [&](const uint8_t* data, size_t size, int64_t total_bytes) {
+        if (fails_randomly && !fails) {
+          // A response of an unknown length fails within its first piece.
+          uint64_t length = total_bytes > 0 ? total_bytes : size;
+          failure = {std::string(), static_cast<uint64_t>(
+              failure_position * length), PP_ERROR_FAILED};
+          fails = true;
+        }
+        while (size) {
+          if (fails && delivered >= failure.offset) {
+            failed = true;
+            return false;
+          }
+          size_t piece = std::min(size, kSliceSize);
+          if (fails)
+            piece = std::min<uint64_t>(piece, failure.offset - delivered);
+          if (next_stall)
+            piece = std::min<uint64_t>(piece, next_stall - delivered);
+          SleepUntil(ReserveLink(piece));
+          if (first_byte < 0.) {
+            first_byte = std::chrono::duration<double>(
+                steady_clock::now() - start).count();
+          }
+          if (!on_data(data, piece, total_bytes))
+            return false;
+          data += piece;
+          size -= piece;
+          delivered += piece;
+          if (next_stall && delivered == next_stall) {
+            SleepUntil(steady_clock::now() +
+                       Seconds(conditions.stall_duration));
+            next_stall += conditions.stall_interval;
+          }
+        }
+        return true;
+      }, response);
+
+  response->timing.first_byte = first_byte;
+  response->timing.total =
+      std::chrono::duration<double>(steady_clock::now() - start).count();
+  if (failed) {
+    LOG_INFO("Emulated failure of %s after %llu bytes", request.url.c_str(),
+             static_cast<unsigned long long>(delivered));
+    return failure.error;
+  }
+  return result;
+}
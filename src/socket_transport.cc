@@ -0,0 +1,338 @@
+/*!
+ * socket_transport.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "socket_transport.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+
+#include "ppapi/c/pp_errors.h"
+
+namespace {
+
+constexpr size_t kReadBufferSize = 64 * 1024;
+// Response headers larger than this are treated as malformed.
+constexpr size_t kMaxHeaderSize = 64 * 1024;
+
+const char kHttpScheme[] = "http://";
+
+constexpr int32_t kHttpSeeOther = 303;
+// Redirects followed by a single request.
+constexpr int32_t kMaxRedirects = 5;
+
+struct Url {
+  std::string host;
+  std::string port;
+  // A path with a query.
+  std::string path;
+};
+
+bool ParseURL(const std::string& url, Url* parsed) {
+  if (url.compare(0, sizeof(kHttpScheme) - 1, kHttpScheme) != 0)
+    return false;
+  auto host_start = sizeof(kHttpScheme) - 1;
+  auto path_start = url.find_first_of("/?#", host_start);
+  std::string authority = url.substr(host_start, path_start - host_start);
+  parsed->path = path_start == std::string::npos ? "/" :
+      url.substr(path_start, url.find('#', path_start) - path_start);
+  if (parsed->path[0] != '/')
+    parsed->path = "/" + parsed->path;
+  // IPv6 literals are given in brackets, e.g. "[::1]:8080".
+  auto port_colon = authority.rfind(':');
+  if (port_colon != std::string::npos &&
+      authority.find(']', port_colon) == std::string::npos) {
+    parsed->host = authority.substr(0, port_colon);
+    parsed->port = authority.substr(port_colon + 1);
+  } else {
+    parsed->host = authority;
+    parsed->port = "80";
+  }
+  if (parsed->host.size() > 2 && parsed->host.front() == '[')
+    parsed->host = parsed->host.substr(1, parsed->host.size() - 2);
+  return !parsed->host.empty();
+}
+
+class Socket {
+ public:
+  Socket() : fd_(-1) {}
+  ~Socket() {
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  Socket(const Socket&) = delete;
+  Socket& operator=(const Socket&) = delete;
+
+  bool Connect(const Url& url, int32_t timeout_ms) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    int result = getaddrinfo(url.host.c_str(), url.port.c_str(), &hints,
+                             &addresses);
+    if (result != 0) {
+      LOG_ERROR("Can't resolve %s: %s", url.host.c_str(),
+                gai_strerror(result));
+      return false;
+    }
+    timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+      fd_ = socket(address->ai_family, address->ai_socktype,
+                   address->ai_protocol);
+      if (fd_ < 0)
+        continue;
+      setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+      if (connect(fd_, address->ai_addr, address->ai_addrlen) == 0)
+        break;
+      close(fd_);
+      fd_ = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd_ < 0)
+      LOG_ERROR("Can't connect to %s:%s", url.host.c_str(), url.port.c_str());
+    return fd_ >= 0;
+  }
+
+  bool Send(const std::string& data) {
+    for (size_t sent = 0; sent < data.size();) {
+      ssize_t result = send(fd_, data.data() + sent, data.size() - sent, 0);
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        return false;
+      sent += result;
+    }
+    return true;
+  }
+
+  // Returns a number of bytes received, 0 when a peer closed a connection or
+  // a negative PP error code.
+  int32_t Receive(uint8_t* buffer, size_t size) {
+    while (true) {
+      ssize_t result = recv(fd_, buffer, size, 0);
+      if (result >= 0)
+        return result;
+      if (errno == EINTR)
+        continue;
+      return (errno == EAGAIN || errno == EWOULDBLOCK) ? PP_ERROR_TIMEDOUT :
+                                                         PP_ERROR_FAILED;
+    }
+  }
+
+ private:
+  int fd_;
+};
+
+// Returns a value of a given header (a name must be lower case), or an
+// empty string if there is no such header.
+std::string HeaderValue(const std::string& headers, const std::string& name) {
+  std::istringstream header_lines(headers);
+  std::string line;
+  while (std::getline(header_lines, line)) {
+    auto colon = line.find(':');
+    if (colon != name.size() ||
+        strncasecmp(line.c_str(), name.c_str(), colon) != 0)
+      continue;
+    auto first = line.find_first_not_of(" \t", colon + 1);
+    auto last = line.find_last_not_of(" \t\r");
+    if (first == std::string::npos)
+      return std::string();
+    return line.substr(first, last - first + 1);
+  }
+  return std::string();
+}
+
+// Resolves a Location header of a redirect against a URL of a request.
+std::string ResolveLocation(const std::string& url,
+                            const std::string& location) {
+  if (location.empty() || location.find("://") != std::string::npos)
+    return location;
+  auto host_start = url.find("://");
+  if (host_start == std::string::npos)
+    return std::string();
+  auto path_start = url.find('/', host_start + 3);
+  std::string origin = url.substr(0, path_start);
+  if (location[0] == '/')
+    return origin + location;
+  // A relative path replaces a last segment of a request path.
+  std::string path = path_start == std::string::npos ? "/" :
+      url.substr(path_start, url.find_first_of("?#", path_start) - path_start);
+  return origin + path.substr(0, path.rfind('/') + 1) + location;
+}
+
+std::string FormatRequest(const HttpRequest& request, const Url& url) {
+  std::ostringstream message;
+  message << request.method << " " << url.path << " HTTP/1.0\r\n"
+          << "Host: " << url.host
+          << (url.port == "80" ? "" : ":" + url.port) << "\r\n"
+          << "Connection: close\r\n";
+  std::istringstream headers(request.headers);
+  std::string line;
+  while (std::getline(headers, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (!line.empty())
+      message << line << "\r\n";
+  }
+  if (!request.body.empty())
+    message << "Content-Length: " << request.body.size() << "\r\n";
+  message << "\r\n";
+  message.write(reinterpret_cast<const char*>(request.body.data()),
+                request.body.size());
+  return message.str();
+}
+
+}  // anonymous namespace
+
+SocketTransport::SocketTransport(int32_t timeout_ms)
+    : timeout_ms_(timeout_ms) {}
+
+int32_t SocketTransport::Fetch(const HttpRequest& request,
+                               const DownloadDataCallback& on_data,
+                               HttpResponseInfo* response) {
+  auto start = std::chrono::steady_clock::now();
+  HttpRequest hop = request;
+  for (int32_t redirects = 0;; ++redirects) {
+    std::string location;
+    int32_t result = FetchOnce(hop, on_data, start, response, &location);
+    if (result != PP_OK || location.empty())
+      return result;
+    if (redirects == kMaxRedirects) {
+      LOG_ERROR("Too many redirects: %s", request.url.c_str());
+      return PP_ERROR_FAILED;
+    }
+    LOG_DEBUG("Redirected from %s to %s", hop.url.c_str(), location.c_str());
+    hop.url = location;
+    // A request is repeated with GET after "303 See Other".
+    if (response->status_code == kHttpSeeOther) {
+      hop.method = "GET";
+      hop.body.clear();
+    }
+  }
+}
+
+int32_t SocketTransport::FetchOnce(const HttpRequest& request,
+                                   const DownloadDataCallback& on_data,
+                                   std::chrono::steady_clock::time_point start,
+                                   HttpResponseInfo* response,
+                                   std::string* location) {
+  using std::chrono::steady_clock;
+  using std::chrono::duration;
+
+  auto elapsed = [&start]() {
+    return duration<double>(steady_clock::now() - start).count();
+  };
+  Url url;
+  if (!ParseURL(request.url, &url)) {
+    LOG_ERROR("Unsupported URL: %s", request.url.c_str());
+    return PP_ERROR_NOTSUPPORTED;
+  }
+  Socket socket;
+  if (!socket.Connect(url, timeout_ms_))
+    return PP_ERROR_CONNECTION_FAILED;
+  response->timing.connect = elapsed();
+  if (!socket.Send(FormatRequest(request, url))) {
+    LOG_ERROR("Failed to send a request: %s", request.url.c_str());
+    return PP_ERROR_CONNECTION_RESET;
+  }
+
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[kReadBufferSize]);
+  std::string head;
+  size_t body_start = std::string::npos;
+  int32_t received;
+  // Reads a status line and headers, they may arrive along with a beginning
+  // of a body.
+  while (body_start == std::string::npos) {
+    received = socket.Receive(buffer.get(), kReadBufferSize);
+    if (received <= 0 || head.size() > kMaxHeaderSize) {
+      LOG_ERROR("Failed to receive a response: %s", request.url.c_str());
+      return received < 0 ? received : PP_ERROR_FAILED;
+    }
+    head.append(reinterpret_cast<char*>(buffer.get()), received);
+    body_start = head.find("\r\n\r\n");
+  }
+  response->timing.first_byte = elapsed();
+  // "HTTP/1.x 200 OK"
+  auto code_start = head.find(' ');
+  response->status_code = code_start == std::string::npos ? 0 :
+      std::strtol(head.c_str() + code_start + 1, nullptr, 10);
+  std::string headers = head.substr(0, body_start);
+  if (response->status_code >= 300 && response->status_code < 400) {
+    // A redirect body isn't passed on, a caller follows Location instead.
+    *location = ResolveLocation(request.url,
+                                HeaderValue(headers, "location"));
+    if (location->empty()) {
+      LOG_ERROR("Redirect without a location: %d", response->status_code);
+      return PP_ERROR_FAILED;
+    }
+    return PP_OK;
+  }
+  if (response->status_code >= 400 || response->status_code < 200) {
+    LOG_ERROR("Unexpected HTTP status code: %d", response->status_code);
+    return PP_ERROR_FAILED;
+  }
+  int64_t content_length = ContentLengthFromHeaders(headers);
+
+  uint64_t body_received = 0;
+  auto pass_on = [&](const uint8_t* data, size_t size) {
+    if (content_length >= 0)
+      size = std::min<uint64_t>(size, content_length - body_received);
+    body_received += size;
+    return size == 0 || on_data(data, size, content_length);
+  };
+  body_start += 4;
+  if (!pass_on(reinterpret_cast<const uint8_t*>(head.data()) + body_start,
+               head.size() - body_start))
+    return PP_ERROR_ABORTED;
+  while (content_length < 0 ||
+         body_received < static_cast<uint64_t>(content_length)) {
+    received = socket.Receive(buffer.get(), kReadBufferSize);
+    if (received < 0) {
+      LOG_ERROR("Failed to receive a response body: %s", request.url.c_str());
+      return received;
+    }
+    if (received == 0)
+      break;
+    if (!pass_on(buffer.get(), received))
+      return PP_ERROR_ABORTED;
+  }
+  // A connection closed before a whole body arrived.
+  if (content_length >= 0 &&
+      body_received < static_cast<uint64_t>(content_length)) {
+    LOG_ERROR("Connection closed after %llu of %lld bytes: %s",
+              static_cast<unsigned long long>(body_received),
+              static_cast<long long>(content_length), request.url.c_str());
+    return PP_ERROR_CONNECTION_CLOSED;
+  }
+  response->timing.total = elapsed();
+  return PP_OK;
+}
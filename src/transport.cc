@@ -0,0 +1,91 @@
+/*!
+ * transport.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "transport.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+#include "ppapi/c/pp_errors.h"
+
+namespace {
+
+constexpr int32_t kHttpOk = 200;
+constexpr int32_t kHttpPartialContent = 206;
+// A size of pieces a resource served from memory is passed on in.
+constexpr uint64_t kServeChunkSize = 64 * 1024;
+
+}  // anonymous namespace
+
+bool ParseRangeHeader(const std::string& headers, uint64_t size,
+                      uint64_t* first, uint64_t* last) {
+  *first = 0;
+  *last = size > 0 ? size - 1 : 0;
+  std::istringstream header_lines(headers);
+  std::string line;
+  while (std::getline(header_lines, line)) {
+    auto colon = line.find(':');
+    if (colon == std::string::npos)
+      continue;
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name != "range")
+      continue;
+    // "Range: bytes=first-last", last is optional. Suffix ranges and
+    // multiple ranges aren't supported.
+    auto equals = line.find('=', colon);
+    auto dash = line.find('-', colon);
+    if (equals == std::string::npos || dash == std::string::npos ||
+        equals > dash)
+      return false;
+    uint64_t range_first = std::strtoull(line.c_str() + equals + 1, nullptr,
+                                         10);
+    uint64_t range_last = *last;
+    auto last_digit = line.find_first_of("0123456789", dash);
+    if (last_digit != std::string::npos)
+      range_last = std::min<uint64_t>(
+          std::strtoull(line.c_str() + last_digit, nullptr, 10), *last);
+    if (range_first >= size || range_first > range_last)
+      return false;
+    *first = range_first;
+    *last = range_last;
+    return true;
+  }
+  return false;
+}
+
+int32_t ServeResource(const HttpRequest& request, const uint8_t* data,
+                      uint64_t size, const DownloadDataCallback& on_data,
+                      HttpResponseInfo* response) {
+  uint64_t first;
+  uint64_t last;
+  bool ranged = ParseRangeHeader(request.headers, size, &first, &last);
+  response->status_code = ranged ? kHttpPartialContent : kHttpOk;
+  response->timing = TransferTiming();
+  response->timing.first_byte = 0.;
+  uint64_t end = size > 0 ? last + 1 : 0;
+  int64_t total_bytes = end - first;
+  for (uint64_t offset = first; offset < end; offset += kServeChunkSize) {
+    if (!on_data(data + offset, std::min(kServeChunkSize, end - offset),
+                 total_bytes))
+      return PP_ERROR_ABORTED;
+  }
+  response->timing.total = 0.;
+  return PP_OK;
+}
@@ -0,0 +1,50 @@
+/*!
+ * common.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_HOST_COMMON_H_
+#define NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_HOST_COMMON_H_
+
+// A host side stand-in for inc/common.h. It provides only what player
+// sources built into the simulator use, without NaCl dependencies. Keep
+// definitions below in sync with inc/common.h.
+
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
+
+void SimLog(const char* level, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#define LOG_INFO(msg, ...) SimLog("INFO", msg, ##__VA_ARGS__)
+#define LOG_ERROR(msg, ...) SimLog("ERROR", msg, ##__VA_ARGS__)
+#define LOG_DEBUG(msg, ...) SimLog("DEBUG", msg, ##__VA_ARGS__)
+
+constexpr double kEps = 0.0001;
+
+template <typename T, class... Args>
+std::unique_ptr<T> MakeUnique(Args&&... args) {
+  return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+enum class AbrPolicyType : int32_t {
+  kThroughput = 0,
+  kBufferBased = 1,
+  kModelPredictive = 2,
+};
+
+#endif  // NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_HOST_COMMON_H_
@@ -0,0 +1,142 @@
+/*!
+ * main.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Usage:
+//   abr_simulator [--policy throughput|buffer|mpc] [--verbose] <manifest.mpd>
+//                 <trace>...
+//
+// Plays a manifest over each given network trace (see network_trace.h) and
+// reports startup time, rebuffering, average video bitrate and numbers of
+// representation switches and abandoned segment downloads per trace and in
+// total.
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+#include "manifest_reader.h"
+#include "network_trace.h"
+#include "simulator.h"
+
+namespace {
+
+bool g_verbose = false;
+
+void PrintUsage(const char* program) {
+  fprintf(stderr, "Usage: %s [--policy throughput|buffer|mpc] [--verbose] "
+          "<manifest.mpd> <trace>...\n", program);
+}
+
+void PrintResult(const std::string& name, const SimResult& result) {
+  printf("%-32s %8.2f %8d %10.2f %10.0f %8d %8d %s\n", name.c_str(),
+         result.startup_time, result.rebuffer_count, result.rebuffer_time,
+         result.average_bitrate / 1000., result.switch_count,
+         result.abandon_count, result.finished ? "" : "(timeout)");
+}
+
+}  // anonymous namespace
+
+void SimLog(const char* level, const char* format, ...) {
+  if (!g_verbose)
+    return;
+  va_list args;
+  va_start(args, format);
+  printf("[%9.2f] %s: ", SimulationTime(), level);
+  vprintf(format, args);
+  printf("\n");
+  va_end(args);
+}
+
+int main(int argc, char* argv[]) {
+  SimConfig config;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--verbose")) {
+      g_verbose = true;
+    } else if (!strcmp(argv[i], "--policy") && i + 1 < argc) {
+      std::string policy = argv[++i];
+      if (policy == "throughput") {
+        config.abr_policy = AbrPolicyType::kThroughput;
+      } else if (policy == "buffer") {
+        config.abr_policy = AbrPolicyType::kBufferBased;
+      } else if (policy == "mpc") {
+        config.abr_policy = AbrPolicyType::kModelPredictive;
+      } else {
+        PrintUsage(argv[0]);
+        return 1;
+      }
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.size() < 2) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::string error;
+  SimManifest manifest;
+  if (!ReadManifest(paths[0], &manifest, &error)) {
+    fprintf(stderr, "%s: %s\n", paths[0].c_str(), error.c_str());
+    return 1;
+  }
+  printf("%s: %.1f s, %zu video and %zu audio representations\n\n",
+         paths[0].c_str(), manifest.duration,
+         manifest.video.representations.size(),
+         manifest.audio.representations.size());
+
+  printf("%-32s %8s %8s %10s %10s %8s %8s\n", "trace", "startup", "stalls",
+         "stalled", "kbps", "switches", "abandons");
+  SimResult total;
+  double total_bitrate = 0.;
+  double virtual_time = 0.;
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 1; i < paths.size(); ++i) {
+    NetworkTrace trace;
+    if (!trace.Load(paths[i], &error)) {
+      fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+    auto result = Simulate(manifest, trace, config);
+    PrintResult(paths[i], result);
+    total.startup_time += result.startup_time;
+    total.rebuffer_count += result.rebuffer_count;
+    total.rebuffer_time += result.rebuffer_time;
+    total.switch_count += result.switch_count;
+    total.abandon_count += result.abandon_count;
+    total_bitrate += result.average_bitrate;
+    virtual_time += result.virtual_time;
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - begin;
+
+  auto count = paths.size() - 1;
+  total.startup_time /= count;
+  total.average_bitrate = total_bitrate / count;
+  total.finished = true;
+  printf("\n");
+  PrintResult("total (startup, kbps averaged)", total);
+  printf("\nSimulated %.0f s in %.3f s (%.0fx real time)\n", virtual_time,
+         elapsed.count(), virtual_time / std::max(elapsed.count(), 1e-6));
+  return 0;
+}
@@ -0,0 +1,418 @@
+/*!
+ * manifest_reader.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "manifest_reader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+namespace {
+
+// Rounding tolerance of segment counts, in segments or seconds.
+constexpr double kMinFraction = 0.001;
+
+// A minimal XML tree, sufficient for MPD files. Namespaces, entities and
+// CDATA sections are not interpreted.
+struct XmlElement {
+  std::string name;
+  std::map<std::string, std::string> attributes;
+  std::string text;
+  const XmlElement* parent = nullptr;
+  std::vector<std::unique_ptr<XmlElement>> children;
+
+  const XmlElement* Child(const std::string& child_name) const {
+    for (const auto& child : children) {
+      if (child->name == child_name)
+        return child.get();
+    }
+    return nullptr;
+  }
+
+  std::string Attribute(const std::string& key) const {
+    auto it = attributes.find(key);
+    return it != attributes.end() ? it->second : std::string();
+  }
+};
+
+std::string LocalName(const std::string& name) {
+  auto pos = name.find(':');
+  return pos == std::string::npos ? name : name.substr(pos + 1);
+}
+
+bool ParseXml(const std::string& xml, XmlElement* root, std::string* error) {
+  std::vector<XmlElement*> open = {root};
+  size_t pos = 0;
+  while (true) {
+    auto tag_begin = xml.find('<', pos);
+    if (open.size() > 1)
+      open.back()->text += xml.substr(pos, tag_begin - pos);
+    if (tag_begin == std::string::npos)
+      break;
+
+    if (xml.compare(tag_begin, 4, "<!--") == 0) {
+      pos = xml.find("-->", tag_begin);
+      if (pos == std::string::npos)
+        break;
+      pos += 3;
+      continue;
+    }
+    auto tag_end = xml.find('>', tag_begin);
+    if (tag_end == std::string::npos) {
+      *error = "unterminated tag";
+      return false;
+    }
+    pos = tag_end + 1;
+    if (xml[tag_begin + 1] == '?' || xml[tag_begin + 1] == '!')
+      continue;
+
+    std::string tag = xml.substr(tag_begin + 1, tag_end - tag_begin - 1);
+    if (tag[0] == '/') {
+      if (open.size() < 2) {
+        *error = "unbalanced closing tag " + tag;
+        return false;
+      }
+      open.pop_back();
+      continue;
+    }
+    bool self_closing = !tag.empty() && tag.back() == '/';
+    if (self_closing)
+      tag.pop_back();
+
+    std::unique_ptr<XmlElement> element(new XmlElement);
+    size_t i = tag.find_first_of(" \t\r\n");
+    element->name = LocalName(tag.substr(0, i));
+    while (i != std::string::npos && i < tag.size()) {
+      auto key_begin = tag.find_first_not_of(" \t\r\n", i);
+      if (key_begin == std::string::npos)
+        break;
+      auto eq = tag.find('=', key_begin);
+      if (eq == std::string::npos)
+        break;
+      auto quote = tag.find_first_of("\"'", eq);
+      if (quote == std::string::npos)
+        break;
+      auto value_end = tag.find(tag[quote], quote + 1);
+      if (value_end == std::string::npos)
+        break;
+      auto key = tag.substr(key_begin, eq - key_begin);
+      key.erase(key.find_last_not_of(" \t\r\n") + 1);
+      element->attributes[LocalName(key)] =
+          tag.substr(quote + 1, value_end - quote - 1);
+      i = value_end + 1;
+    }
+
+    element->parent = open.back();
+    XmlElement* raw = element.get();
+    open.back()->children.push_back(std::move(element));
+    if (!self_closing)
+      open.push_back(raw);
+  }
+  return true;
+}
+
+// Parses an ISO 8601 duration, e.g. "PT1H2M3.5S".
+double ParseDuration(const std::string& text) {
+  double seconds = 0.;
+  double value = 0.;
+  bool in_time = false;
+  const char* p = text.c_str();
+  while (*p) {
+    if (*p == 'P') {
+      ++p;
+    } else if (*p == 'T') {
+      in_time = true;
+      ++p;
+    } else {
+      char* end = nullptr;
+      value = std::strtod(p, &end);
+      if (end == p || !*end)
+        break;
+      switch (*end) {
+        case 'D': seconds += value * 86400.; break;
+        case 'H': seconds += value * 3600.; break;
+        case 'M': seconds += value * (in_time ? 60. : 30. * 86400.); break;
+        case 'S': seconds += value; break;
+        default: break;
+      }
+      p = end + 1;
+    }
+  }
+  return seconds;
+}
+
+bool ParseRange(const std::string& range, uint64_t* begin, uint64_t* end) {
+  auto dash = range.find('-');
+  if (range.empty() || dash == std::string::npos)
+    return false;
+  *begin = std::strtoull(range.substr(0, dash).c_str(), nullptr, 10);
+  *end = std::strtoull(range.substr(dash + 1).c_str(), nullptr, 10);
+  return *end >= *begin;
+}
+
+// Finds a closest child element of a given name of a representation, its
+// adaptation set or its period.
+const XmlElement* Inherited(const XmlElement* representation,
+                            const std::string& name) {
+  for (auto element = representation; element && element->name != "MPD";
+       element = element->parent) {
+    if (auto child = element->Child(name))
+      return child;
+  }
+  return nullptr;
+}
+
+std::string Trim(const std::string& text) {
+  auto begin = text.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos)
+    return std::string();
+  return text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+std::string BaseUrl(const XmlElement* representation) {
+  std::string url;
+  for (auto element = representation; element; element = element->parent) {
+    if (auto base = element->Child("BaseURL")) {
+      auto part = Trim(base->text);
+      if (part.find("://") != std::string::npos || (!part.empty() &&
+          part[0] == '/'))
+        return part + url;
+      url = part + url;
+    }
+  }
+  return url;
+}
+
+template <typename T>
+T NextUnsigned(const uint8_t*& data) {
+  T value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i)
+    value = (value << 8) | *data++;
+  return value;
+}
+
+// Reads segment sizes and durations from a sidx box of a local media file.
+bool ReadSidx(const std::string& path, uint64_t begin, uint64_t end,
+              std::vector<SimSegment>* segments, std::string* error) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    *error = "can't open " + path + ", a local copy of a media file is "
+             "needed to read segment sizes of SegmentBase representations";
+    return false;
+  }
+  std::vector<uint8_t> box(end - begin + 1);
+  file.seekg(begin);
+  file.read(reinterpret_cast<char*>(box.data()), box.size());
+  if (file.gcount() != static_cast<std::streamsize>(box.size()) ||
+      box.size() < 32 || std::string(box.begin() + 4, box.begin() + 8) !=
+          "sidx") {
+    *error = "no sidx box in " + path;
+    return false;
+  }
+
+  const uint8_t* data = box.data() + 8;
+  uint8_t version = *data;
+  data += 4 + 4;  // version, flags and reference_ID
+  uint32_t timescale = NextUnsigned<uint32_t>(data);
+  data += version == 0 ? 8 : 16;  // earliest_presentation_time, first_offset
+  data += 2;  // reserved
+  uint16_t count = NextUnsigned<uint16_t>(data);
+  if (!timescale || data + count * 12 > box.data() + box.size()) {
+    *error = "malformed sidx box in " + path;
+    return false;
+  }
+  for (uint16_t i = 0; i < count; ++i) {
+    uint32_t size = NextUnsigned<uint32_t>(data) & 0x7fffffff;
+    uint32_t duration = NextUnsigned<uint32_t>(data);
+    data += 4;  // SAP
+    segments->push_back({static_cast<double>(duration) / timescale, size});
+  }
+  return true;
+}
+
+std::vector<double> TemplateDurations(const XmlElement* segment_template,
+                                      double total_duration) {
+  std::vector<double> durations;
+  double timescale = std::atof(segment_template->Attribute("timescale")
+                                   .c_str());
+  if (timescale <= 0.)
+    timescale = 1.;
+
+  if (auto timeline = segment_template->Child("SegmentTimeline")) {
+    double time = 0.;
+    for (const auto& s : timeline->children) {
+      if (s->name != "S")
+        continue;
+      if (!s->Attribute("t").empty())
+        time = std::atof(s->Attribute("t").c_str()) / timescale;
+      double duration = std::atof(s->Attribute("d").c_str()) / timescale;
+      int repeat = std::atoi(s->Attribute("r").c_str());
+      if (duration <= 0.)
+        continue;
+      if (repeat < 0)
+        repeat = std::ceil((total_duration - time) / duration -
+                           kMinFraction) - 1;
+      for (int i = 0; i <= repeat; ++i) {
+        durations.push_back(duration);
+        time += duration;
+      }
+    }
+    return durations;
+  }
+
+  double duration = std::atof(segment_template->Attribute("duration")
+                                  .c_str()) / timescale;
+  if (duration <= 0.)
+    return durations;
+  for (double time = 0.; time < total_duration - kMinFraction;
+       time += duration)
+    durations.push_back(std::min(duration, total_duration - time));
+  return durations;
+}
+
+bool ReadRepresentation(const XmlElement* element, const std::string& mpd_dir,
+                        double total_duration,
+                        SimRepresentation* representation,
+                        std::string* error) {
+  representation->bitrate =
+      std::strtoul(element->Attribute("bandwidth").c_str(), nullptr, 10);
+  auto& segments = representation->segments;
+
+  if (auto segment_base = Inherited(element, "SegmentBase")) {
+    uint64_t begin = 0, end = 0;
+    if (!ParseRange(segment_base->Attribute("indexRange"), &begin, &end)) {
+      *error = "SegmentBase without indexRange";
+      return false;
+    }
+    return ReadSidx(mpd_dir + BaseUrl(element), begin, end, &segments, error);
+  }
+
+  if (auto segment_list = Inherited(element, "SegmentList")) {
+    double timescale =
+        std::atof(segment_list->Attribute("timescale").c_str());
+    if (timescale <= 0.)
+      timescale = 1.;
+    double duration =
+        std::atof(segment_list->Attribute("duration").c_str()) / timescale;
+    for (const auto& url : segment_list->children) {
+      if (url->name != "SegmentURL")
+        continue;
+      uint64_t begin = 0, end = 0;
+      uint64_t size = ParseRange(url->Attribute("mediaRange"), &begin, &end) ?
+          end - begin + 1 : representation->bitrate * duration / 8;
+      segments.push_back({duration, size});
+    }
+    return true;
+  }
+
+  if (auto segment_template = Inherited(element, "SegmentTemplate")) {
+    for (auto duration : TemplateDurations(segment_template, total_duration)) {
+      segments.push_back({duration, static_cast<uint64_t>(
+          representation->bitrate * duration / 8)});
+    }
+    return true;
+  }
+
+  *error = "representation without segment information";
+  return false;
+}
+
+}  // anonymous namespace
+
+bool ReadManifest(const std::string& path, SimManifest* manifest,
+                  std::string* error) {
+  std::ifstream file(path);
+  if (!file) {
+    *error = "can't open " + path;
+    return false;
+  }
+  std::stringstream content;
+  content << file.rdbuf();
+
+  XmlElement root;
+  if (!ParseXml(content.str(), &root, error))
+    return false;
+  auto mpd = root.Child("MPD");
+  auto period = mpd ? mpd->Child("Period") : nullptr;
+  if (!period) {
+    *error = "no MPD period";
+    return false;
+  }
+
+  auto slash = path.find_last_of('/');
+  std::string mpd_dir =
+      slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+  manifest->duration =
+      ParseDuration(mpd->Attribute("mediaPresentationDuration"));
+  if (manifest->duration <= 0.)
+    manifest->duration = ParseDuration(period->Attribute("duration"));
+
+  for (const auto& adaptation_set : period->children) {
+    if (adaptation_set->name != "AdaptationSet")
+      continue;
+    for (const auto& element : adaptation_set->children) {
+      if (element->name != "Representation")
+        continue;
+      std::string type = adaptation_set->Attribute("contentType");
+      if (type.empty()) {
+        type = element->Attribute("mimeType");
+        if (type.empty())
+          type = adaptation_set->Attribute("mimeType");
+      }
+      SimStream* stream = nullptr;
+      if (type.compare(0, 5, "video") == 0)
+        stream = &manifest->video;
+      else if (type.compare(0, 5, "audio") == 0)
+        stream = &manifest->audio;
+      else
+        continue;
+
+      SimRepresentation representation;
+      if (!ReadRepresentation(element.get(), mpd_dir, manifest->duration,
+                              &representation, error)) {
+        *error = "representation " + element->Attribute("id") + ": " + *error;
+        return false;
+      }
+      stream->representations.push_back(std::move(representation));
+    }
+  }
+
+  for (auto stream : {&manifest->video, &manifest->audio}) {
+    auto& representations = stream->representations;
+    std::stable_sort(representations.begin(), representations.end(),
+        [](const SimRepresentation& a, const SimRepresentation& b) {
+          return a.bitrate < b.bitrate;
+        });
+    for (size_t i = 0; i < representations.size(); ++i)
+      representations[i].id = i;
+  }
+
+  if (manifest->video.representations.empty()) {
+    *error = "no video representations";
+    return false;
+  }
+  if (manifest->duration <= 0.) {
+    manifest->duration = 0.;
+    for (const auto& segment : manifest->video.representations[0].segments)
+      manifest->duration += segment.duration;
+  }
+  return true;
+}
@@ -0,0 +1,59 @@
+/*!
+ * manifest_reader.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_MANIFEST_READER_H_
+#define NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_MANIFEST_READER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+struct SimSegment {
+  double duration;  // in seconds
+  uint64_t size;    // in bytes
+};
+
+struct SimRepresentation {
+  uint32_t id;
+  uint32_t bitrate;  // in bits per second
+  std::vector<SimSegment> segments;
+};
+
+struct SimStream {
+  // Sorted by bitrate, lowest first. Ids are indices in this vector, as
+  // they would be given by the player.
+  std::vector<SimRepresentation> representations;
+};
+
+struct SimManifest {
+  double duration;  // in seconds
+  SimStream video;
+  SimStream audio;
+};
+
+// Reads a first period of a static MPD. Segment sizes are taken from sidx
+// boxes for SegmentBase representations (a media file has to be available
+// locally, at a BaseURL relative to the MPD), from mediaRange attributes
+// for SegmentList representations, and are derived from a declared
+// bandwidth otherwise.
+//
+// Returns false and sets error if the MPD can't be read.
+bool ReadManifest(const std::string& path, SimManifest* manifest,
+                  std::string* error);
+
+#endif  // NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_MANIFEST_READER_H_
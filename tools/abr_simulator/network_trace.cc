@@ -0,0 +1,82 @@
+/*!
+ * network_trace.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "network_trace.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+bool NetworkTrace::Load(const std::string& path, std::string* error) {
+  std::ifstream file(path);
+  if (!file) {
+    *error = "can't open " + path;
+    return false;
+  }
+  periods_.clear();
+  total_duration_ = 0.;
+
+  std::string line;
+  for (int line_number = 1; std::getline(file, line); ++line_number) {
+    auto begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos || line[begin] == '#')
+      continue;
+    std::istringstream fields(line);
+    Period period = {0., 0., 0.};
+    double latency_ms = 0.;
+    if (!(fields >> period.duration >> period.bandwidth) ||
+        period.duration <= 0. || period.bandwidth < 0.) {
+      *error = path + ":" + std::to_string(line_number) + ": malformed period";
+      return false;
+    }
+    if (fields >> latency_ms)
+      period.latency = latency_ms / 1000.;
+    period.bandwidth *= 1000.;
+    total_duration_ += period.duration;
+    periods_.push_back(period);
+  }
+  if (periods_.empty()) {
+    *error = path + ": empty trace";
+    return false;
+  }
+  return true;
+}
+
+size_t NetworkTrace::IndexAt(double time, double* period_begin) const {
+  double cycle_begin = std::floor(time / total_duration_) * total_duration_;
+  double begin = cycle_begin;
+  for (size_t i = 0; i < periods_.size(); ++i) {
+    if (time < begin + periods_[i].duration || i + 1 == periods_.size()) {
+      *period_begin = begin;
+      return i;
+    }
+    begin += periods_[i].duration;
+  }
+  *period_begin = cycle_begin;
+  return 0;
+}
+
+const NetworkTrace::Period& NetworkTrace::PeriodAt(double time) const {
+  double begin = 0.;
+  return periods_[IndexAt(time, &begin)];
+}
+
+double NetworkTrace::PeriodEnd(double time) const {
+  double begin = 0.;
+  auto index = IndexAt(time, &begin);
+  return begin + periods_[index].duration;
+}
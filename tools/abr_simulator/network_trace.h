@@ -0,0 +1,53 @@
+/*!
+ * network_trace.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_NETWORK_TRACE_H_
+#define NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_NETWORK_TRACE_H_
+
+#include <string>
+#include <vector>
+
+// Network conditions changing over time. A trace file has one period per
+// line:
+//   <duration [s]> <bandwidth [kbit/s]> [<latency [ms]>]
+// Empty lines and lines starting with '#' are ignored. A trace is repeated
+// if a simulation lasts longer than the trace.
+class NetworkTrace {
+ public:
+  struct Period {
+    double duration;   // in seconds
+    double bandwidth;  // in bits per second
+    double latency;    // in seconds
+  };
+
+  // Returns false and sets error if the file can't be read.
+  bool Load(const std::string& path, std::string* error);
+
+  // Returns a period in effect at a given time.
+  const Period& PeriodAt(double time) const;
+
+  // Returns a time at which a period in effect at a given time ends.
+  double PeriodEnd(double time) const;
+
+ private:
+  size_t IndexAt(double time, double* period_begin) const;
+
+  std::vector<Period> periods_;
+  double total_duration_ = 0.;
+};
+
+#endif  // NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_NETWORK_TRACE_H_
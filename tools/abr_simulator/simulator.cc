@@ -0,0 +1,350 @@
+/*!
+ * simulator.cc (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "simulator.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "abr_controller.h"
+#include "bandwidth_estimator.h"
+#include "buffering_policy.h"
+
+namespace {
+
+double g_simulation_time = 0.;
+
+struct Download {
+  bool active = false;
+  double started = 0.;
+  double finished = 0.;
+  double latency_left = 0.;
+  double bytes_left = 0.;
+  uint64_t size = 0;
+  double duration = 0.;
+  double segment_end = 0.;
+  double deadline = 0.;
+  uint32_t bitrate = 0;
+};
+
+// Mirrors a state of StreamManager relevant to scheduling: a representation
+// in use, a next segment and a time of downloaded segments. Like
+// StreamManager, a stream has at most one segment download pending, which is
+// abandoned as AsyncDataProvider does when it would miss its deadline.
+class SimStreamState {
+ public:
+  SimStreamState(const SimStream* stream, const NetworkTrace* trace)
+      : stream_(stream),
+        trace_(trace),
+        representation_(0),
+        next_segment_(0),
+        next_segment_time_(0.),
+        buffered_time_(0.),
+        segment_abandonment_(false),
+        segment_abandoned_(false) {}
+
+  bool IsPresent() const { return !stream_->representations.empty(); }
+
+  uint32_t representation() const { return representation_; }
+  void set_representation(uint32_t id) { representation_ = id; }
+
+  double buffered_time() const { return buffered_time_; }
+
+  const Download& download() const { return download_; }
+
+  void set_segment_abandonment(bool enabled) {
+    segment_abandonment_ = enabled;
+  }
+
+  bool IsLastSegmentAbandoned() const { return segment_abandoned_; }
+
+  bool HasMoreSegments() const {
+    return next_segment_ < Segments().size();
+  }
+
+  bool IsSegmentRequestDue(double playback_time) const {
+    if (!IsPresent() || download_.active || !HasMoreSegments())
+      return false;
+    const auto& segments = Segments();
+    double average_duration = 0.;
+    for (const auto& segment : segments)
+      average_duration += segment.duration;
+    average_duration /= segments.size();
+    return ::IsSegmentRequestDue(buffered_time_ - playback_time,
+                                 average_duration, false, false);
+  }
+
+  // Requests a next segment if it's due, as StreamManager::UpdateBuffer does.
+  // Returns false if there are no more segments to request.
+  bool UpdateBuffer(double playback_time) {
+    if (IsSegmentRequestDue(playback_time)) {
+      RequestSegment(trace_->PeriodAt(g_simulation_time).latency,
+                     SegmentRequestDeadline(buffered_time_ - playback_time,
+                                            segment_abandonment_, false));
+      segment_abandoned_ = false;
+    }
+    return HasMoreSegments() || download_.active;
+  }
+
+  void RequestSegment(double latency, double deadline) {
+    const auto& segment = Segments()[next_segment_];
+    download_.active = true;
+    download_.deadline = deadline;
+    download_.started = g_simulation_time;
+    download_.latency_left = latency;
+    download_.bytes_left = segment.size;
+    download_.size = segment.size;
+    download_.duration = segment.duration;
+    download_.segment_end = next_segment_time_ + segment.duration;
+    download_.bitrate = stream_->representations[representation_].bitrate;
+    next_segment_time_ += segment.duration;
+    ++next_segment_;
+  }
+
+  bool IsTransferring() const {
+    return download_.active && download_.latency_left <= 0.;
+  }
+
+  // Advances a download by a given time starting at a given moment, during
+  // which a given number of bytes can be transferred.
+  void Transfer(double time, double seconds, double bytes) {
+    if (!download_.active || download_.bytes_left <= 0.)
+      return;
+    if (download_.latency_left > 0.) {
+      download_.latency_left -= seconds;
+    } else {
+      if (bytes >= download_.bytes_left)
+        download_.finished = time + seconds * download_.bytes_left / bytes;
+      download_.bytes_left -= bytes;
+    }
+  }
+
+  // Abandons a download which is projected to miss its deadline, so a segment
+  // is requested again, possibly in another representation. Returns a number
+  // of bytes transferred before a download was abandoned, or 0 if it wasn't.
+  double AbandonLateDownload() {
+    if (!download_.active || download_.bytes_left <= 0.)
+      return 0.;
+    // Like a progress callback, this is checked once some data arrives.
+    double received = download_.size - download_.bytes_left;
+    if (received <= 0. || !IsDownloadLate(g_simulation_time - download_.started,
+                        static_cast<size_t>(received), download_.size,
+                        download_.deadline))
+      return 0.;
+    LOG_INFO("Abandoning a segment: %.2f [s], %.0f of %llu bytes",
+             download_.segment_end - download_.duration, received,
+             static_cast<unsigned long long>(download_.size));
+    download_.active = false;
+    next_segment_time_ -= download_.duration;
+    --next_segment_;
+    segment_abandoned_ = true;
+    return received;
+  }
+
+  // Returns true if a download has just finished.
+  bool FinishDownload() {
+    if (!download_.active || download_.bytes_left > 0.)
+      return false;
+    download_.active = false;
+    buffered_time_ = download_.segment_end;
+    return true;
+  }
+
+ private:
+  const std::vector<SimSegment>& Segments() const {
+    return stream_->representations[representation_].segments;
+  }
+
+  const SimStream* stream_;
+  const NetworkTrace* trace_;
+  uint32_t representation_;
+  size_t next_segment_;
+  double next_segment_time_;
+  double buffered_time_;
+  bool segment_abandonment_;
+  bool segment_abandoned_;
+  Download download_;
+};
+
+void AdvanceNetwork(const NetworkTrace& trace, double step,
+                    std::vector<SimStreamState*>* streams) {
+  double time = g_simulation_time;
+  double end = time + step;
+  while (time < end) {
+    double period_end = std::min(end, trace.PeriodEnd(time));
+    if (period_end <= time)
+      period_end = end;
+    const auto& period = trace.PeriodAt(time);
+    int transferring = 0;
+    for (auto stream : *streams)
+      transferring += stream->IsTransferring();
+    double bytes = transferring ?
+        period.bandwidth / 8. * (period_end - time) / transferring : 0.;
+    for (auto stream : *streams)
+      stream->Transfer(time, period_end - time, bytes);
+    time = period_end;
+  }
+}
+
+}  // anonymous namespace
+
+double SimulationTime() {
+  return g_simulation_time;
+}
+
+SimResult Simulate(const SimManifest& manifest, const NetworkTrace& trace,
+                   const SimConfig& config) {
+  SimResult result;
+  g_simulation_time = 0.;
+
+  SimStreamState video(&manifest.video, &trace);
+  SimStreamState audio(&manifest.audio, &trace);
+  std::vector<SimStreamState*> streams = {&video};
+  if (audio.IsPresent())
+    streams.push_back(&audio);
+
+  auto estimator = std::make_shared<BandwidthEstimator>();
+  std::vector<AbrRepresentation> ladder;
+  for (const auto& representation : manifest.video.representations)
+    // A resolution cap isn't simulated, so resolutions aren't needed.
+    ladder.push_back({representation.id, representation.bitrate, 0, 0});
+  AbrController video_abr(ladder, estimator, config.abr_policy);
+  // Segment sizes read from a manifest are known in advance, as a player
+  // knows them from a segment index.
+  video_abr.SetSegmentLookup([&manifest](uint32_t id, double time,
+                                         size_t count) {
+    std::vector<AbrSegment> upcoming;
+    double segment_time = 0.;
+    for (const auto& segment : manifest.video.representations[id].segments) {
+      if (upcoming.size() >= count)
+        break;
+      if (segment_time + segment.duration > time + kEps) {
+        upcoming.push_back({segment.duration,
+                            static_cast<int64_t>(segment.size)});
+      }
+      segment_time += segment.duration;
+    }
+    return upcoming;
+  });
+  if (audio.IsPresent()) {
+    // Audio representation is always the highest one, as in the player.
+    audio.set_representation(manifest.audio.representations.size() - 1);
+    video_abr.SetReservedBandwidth(
+        manifest.audio.representations.back().bitrate);
+  }
+  video.set_representation(video_abr.SelectInitialRepresentation());
+  // As EsDashPlayerController::UpdateSegmentAbandonment does, video segments
+  // are abandoned only if there is a lower representation to switch to.
+  auto update_segment_abandonment = [&video, &video_abr]() {
+    video.set_segment_abandonment(
+        video_abr.HasLowerRepresentation(video.representation()));
+  };
+  update_segment_abandonment();
+
+  double playback_time = 0.;
+  bool playing = false;
+  bool started = false;
+  double stall_begin = 0.;
+  double video_bits = 0.;
+  double video_duration = 0.;
+  double timeout = manifest.duration * config.timeout_ratio;
+
+  while (g_simulation_time < timeout) {
+    UpdateStreamBuffers(playback_time, &video, streams,
+                        [&](double time) {
+      auto buffer_level = std::max(video.buffered_time() - time, 0.);
+      // A segment download abandoned in a current representation is
+      // requested again, so this must choose a lower one.
+      auto id = video.IsLastSegmentAbandoned() ?
+          video_abr.SelectRepresentationAfterAbandonment(video.representation(),
+              time, buffer_level) :
+          video_abr.SelectRepresentation(video.representation(), time,
+                                         buffer_level);
+      if (id != video.representation()) {
+        ++result.switch_count;
+        video.set_representation(id);
+        update_segment_abandonment();
+      }
+    });
+
+    AdvanceNetwork(trace, config.step, &streams);
+    g_simulation_time += config.step;
+
+    for (auto stream : streams) {
+      double received = stream->AbandonLateDownload();
+      if (received <= 0.)
+        continue;
+      // A partial download still tells how fast the network is.
+      estimator->AddSample(static_cast<size_t>(received),
+                           stream->download().started, g_simulation_time, 0.);
+      result.downloaded_bytes += received;
+      ++result.abandon_count;
+    }
+
+    bool all_downloaded = true;
+    double buffered_time = manifest.duration;
+    for (auto stream : streams) {
+      if (stream->FinishDownload()) {
+        const auto& download = stream->download();
+        estimator->AddSample(download.size, download.started,
+                             download.finished, download.duration);
+        result.downloaded_bytes += download.size;
+        if (stream == &video) {
+          video_bits += static_cast<double>(download.bitrate) *
+                        download.duration;
+          video_duration += download.duration;
+        }
+      }
+      all_downloaded &= !stream->HasMoreSegments() &&
+                        !stream->download().active;
+      buffered_time = std::min(buffered_time, stream->buffered_time());
+    }
+    if (all_downloaded)
+      buffered_time = manifest.duration;
+
+    if (playing) {
+      playback_time = std::min(playback_time + config.step, buffered_time);
+      if (playback_time >= manifest.duration - kEps) {
+        result.finished = true;
+        break;
+      }
+      if (playback_time >= buffered_time - kEps) {
+        LOG_INFO("Playback stalled at %.2f [s]", playback_time);
+        playing = false;
+        stall_begin = g_simulation_time;
+        ++result.rebuffer_count;
+      }
+    } else if (buffered_time - playback_time >= std::min(config.resume_level,
+                   manifest.duration - playback_time) - kEps) {
+      playing = true;
+      if (!started) {
+        started = true;
+        result.startup_time = g_simulation_time;
+      } else {
+        result.rebuffer_time += g_simulation_time - stall_begin;
+      }
+    }
+  }
+
+  if (!playing && started)
+    result.rebuffer_time += g_simulation_time - stall_begin;
+  if (video_duration > 0.)
+    result.average_bitrate = video_bits / video_duration;
+  result.virtual_time = g_simulation_time;
+  return result;
+}
@@ -0,0 +1,61 @@
+/*!
+ * simulator.h (https://github.com/SamsungDForum/NativePlayer)
+ * Copyright 2016, Samsung Electronics Co., Ltd
+ * Licensed under the MIT license
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_SIMULATOR_H_
+#define NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_SIMULATOR_H_
+
+#include "common.h"
+
+#include "manifest_reader.h"
+#include "network_trace.h"
+
+struct SimConfig {
+  AbrPolicyType abr_policy = AbrPolicyType::kThroughput;
+  // A step of a virtual clock, as often as EsDashPlayerController updates
+  // stream buffers.
+  double step = 0.05;
+  // Media buffered ahead of a playback position needed to (re)start a
+  // playback after a startup or a stall, in seconds.
+  double resume_level = 1.;
+  // A playback is abandoned if it doesn't finish in this many times its
+  // duration of virtual time (e.g. when a trace has no bandwidth).
+  double timeout_ratio = 100.;
+};
+
+struct SimResult {
+  bool finished = false;
+  double startup_time = 0.;     // in seconds
+  int rebuffer_count = 0;
+  double rebuffer_time = 0.;    // in seconds
+  double average_bitrate = 0.;  // of video, in bits per second
+  int switch_count = 0;
+  int abandon_count = 0;        // of segment downloads
+  double downloaded_bytes = 0.;
+  double virtual_time = 0.;     // in seconds
+};
+
+// Plays a manifest over a simulated network with a virtual clock. Segments
+// are requested and late downloads abandoned by the same logic as the player
+// uses (see buffering_policy.h) and video representations are chosen by the
+// player's AbrController, the same way as EsDashPlayerController does.
+SimResult Simulate(const SimManifest& manifest, const NetworkTrace& trace,
+                   const SimConfig& config);
+
+// Virtual time of a running simulation, used to timestamp log messages.
+double SimulationTime();
+
+#endif  // NATIVE_PLAYER_TOOLS_ABR_SIMULATOR_SIMULATOR_H_